@@ -28,8 +28,63 @@
 #
 ******************************************************************************/
 #include <stdlib.h>
+#include <string.h>
 #include "epd2in13_V3.h"
 
+static_assert(EPD_ROW_BYTES <= EPD_RAM_MAX_ROW_BYTES && EPD_HEIGHT <= EPD_RAM_MAX_HEIGHT,
+              "panel larger than the epdram.h buffers");
+
+/* Controller command tables, see epdseq.h: opcode, length [| wait], payload */
+static constexpr unsigned char seq_init_full[] = {
+    0x12, 0 | EPD_SEQ_WAIT,                     // soft reset
+    0x44, 2, 0x00, (EPD_WIDTH - 1) >> 3,        // SetWindows(0, 0, EPD_WIDTH-1, EPD_HEIGHT-1)
+    0x45, 4, 0x00, 0x00, (EPD_HEIGHT - 1) & 0xFF, (EPD_HEIGHT - 1) >> 8,
+    0x4E, 1, 0x00,                              // SetCursor(0, 0)
+    0x4F, 2, 0x00, 0x00,
+    0x3C, 1, 0x05,                              // BorderWavefrom
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_init_full);
+
+/* Panel geometry and source/sensor selection. A reset (hardware pulse or
+ * 0x12) puts these back to their power-on values, so both modes send them
+ * after every reset, including the wake from deep sleep */
+static constexpr unsigned char seq_init_panel[] = {
+    0x01, 3, 0xF9, 0x00, 0x00,                  // Driver output control
+    0x11, 1, 0x03,                              // data entry mode
+    0x21, 2, 0x00, 0x80,                        // Display update control
+    0x18, 1 | EPD_SEQ_WAIT, 0x80,               // Read built-in temperature sensor
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_init_panel);
+
+static constexpr unsigned char seq_init_part[] = {
+    0x37, 10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00,   // RAM ping-pong on
+    0x3C, 1, 0x80,                              // BorderWavefrom
+    0x22, 1, 0xC0,                              // Enable clock and  Enable analog
+    0x20, 0 | EPD_SEQ_WAIT,                     // Activate Display Update Sequence
+    0x44, 2, 0x00, (EPD_WIDTH - 1) >> 3,        // SetWindows(0, 0, EPD_WIDTH-1, EPD_HEIGHT-1)
+    0x45, 4, 0x00, 0x00, (EPD_HEIGHT - 1) & 0xFF, (EPD_HEIGHT - 1) >> 8,
+    0x4E, 1, 0x00,                              // SetCursor(0, 0)
+    0x4F, 2, 0x00, 0x00,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_init_part);
+
+static constexpr unsigned char seq_refresh_full[] = {
+    0x22, 1, 0xC7,
+    0x20, 0 | EPD_SEQ_WAIT,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_refresh_full);
+
+static constexpr unsigned char seq_refresh_part[] = {
+    0x22, 1, 0xCF,      // clock + analog on, display mode 2, both off again
+    0x20, 0 | EPD_SEQ_WAIT,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_refresh_part);
+
 const unsigned char lut_full_update[]= {
 	0x80,	0x4A,	0x40,	0x0,	0x0,	0x0,	0x0,	0x0,	0x0,	0x0,	0x0,	0x0,
 	0x40,	0x4A,	0x80,	0x0,	0x0,	0x0,	0x0,	0x0,	0x0,	0x0,	0x0,	0x0,
@@ -74,6 +129,89 @@ const unsigned char lut_partial_update[]= {
 	0x22,0x17,0x41,0x00,0x32,0x36,
 };
 
+/* Same waveform with the first phase twice as long (0x14 -> 0x28 frames):
+ * below EPD_TEMP_COLD the particles move slower and the stock partial
+ * waveform leaves grey smears */
+const unsigned char lut_partial_cold[]= { 
+	0x0,0x40,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x80,0x80,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x40,0x40,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x80,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x28,0x0,0x0,0x0,0x0,0x0,0x0,  
+	0x1,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x1,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+	0x22,0x22,0x22,0x22,0x22,0x22,0x0,0x0,0x0,
+	0x22,0x17,0x41,0x00,0x32,0x36,
+};
+
+/* 4-gray waveform from the vendor's 2.9" V2 (SSD1680) demo: RAM 0x24 and
+ * 0x26 together select one of four levels, see DisplayGray4() */
+const unsigned char lut_gray4[]= {
+	0x00,	0x60,	0x10,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	//VS L0
+	0x20,	0x60,	0x10,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	//VS L1
+	0x28,	0x60,	0x14,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	//VS L2
+	0x2A,	0x60,	0x15,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	//VS L3
+	0x00,	0x90,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	//VS L4
+	0x00,	0x02,	0x00,	0x05,	0x14,	0x00,	0x00,	//TP, SR, RP of Group0
+	0x1E,	0x1E,	0x00,	0x00,	0x00,	0x00,	0x01,	//TP, SR, RP of Group1
+	0x00,	0x02,	0x00,	0x05,	0x14,	0x00,	0x00,	//TP, SR, RP of Group2
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,	0x00,
+	0x24,	0x22,	0x22,	0x22,	0x23,	0x32,	0x00,	0x00,	0x00,	//FR, XON
+	0x22,	0x17,	0x41,	0xAE,	0x32,	0x28,	//EOPT VGH VSH1 VSH2 VSL VCOM
+};
+
+/* LUT bank, coldest band first; a band is used from min_c up to the next */
+struct LutBand {
+    int min_c;
+    const unsigned char* full;
+    const unsigned char* part;
+};
+
+static const LutBand lut_bank[] = {
+    { EPD_TEMP_UNKNOWN, lut_full_update, lut_partial_cold },
+    { EPD_TEMP_COLD,    lut_full_update, lut_partial_update },
+};
+#define LUT_BAND_DEFAULT    1   // used while the temperature is unknown
+
+/* Latch the internal sensor into 0x1B (0x22 = 0xB1 also reloads the OTP LUT,
+ * so the next Lut() has to upload again) */
+static constexpr unsigned char seq_load_temp[] = {
+    0x18, 1, 0x80,                              // internal temperature sensor
+    0x22, 1, 0xB1,
+    0x20, 0 | EPD_SEQ_WAIT,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_load_temp);
+
+/* Fast full refresh: pretend the panel is at 100 degC (0x1A) and load the
+ * OTP waveform for that temperature, which drives the particles in a few
+ * short phases instead of the slow room-temperature sequence */
+static constexpr unsigned char seq_fast_full[] = {
+    0x1A, 2, 0x64, 0x00,                        // temperature register = 100 degC
+    0x22, 1, 0x91,                              // load the OTP LUT for it
+    0x20, 0 | EPD_SEQ_WAIT,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_fast_full);
+
 Epd::~Epd()
 {
 };
@@ -82,16 +220,17 @@ Epd::~Epd()
 function :	Pin definition
 parameter:
 ******************************************************************************/
-Epd::Epd()
+Epd::Epd() : EpdRam(EPD_ROW_BYTES, EPD_HEIGHT, EPD_SPI_CLOCK_MAX)
 {
-    reset_pin = RST_PIN;
-    dc_pin = DC_PIN;
-    cs_pin = CS_PIN;
-    busy_pin = BUSY_PIN;
     width = EPD_WIDTH;
     height = EPD_HEIGHT;
-    bufwidth = 128/8;  //16
-    bufheight = 63;
+    pingpong = false;
+    old_stale = false;
+    asleep = false;
+    temperature = EPD_TEMP_UNKNOWN;
+    temp_read_at = 0;
+    temp_valid = false;
+    Invalidate();
 };
 
 /******************************************************************************
@@ -101,32 +240,21 @@ parameter:
 ******************************************************************************/
 void Epd::SendCommand(unsigned char command)
 {
-    DigitalWrite(dc_pin, LOW);
-    SpiTransfer(command);
-}
-
-/******************************************************************************
-function :	send data
-parameter:
-    Data : Write data
-******************************************************************************/
-void Epd::SendData(unsigned char data)
-{
-    DigitalWrite(dc_pin, HIGH);
-    SpiTransfer(data);
+    if (command == 0x24 || command == 0x26 || command == 0x27 ||
+        command == 0x46 || command == 0x47) {
+        cursor_known = false;   // RAM access and auto-fill move the address counter
+    }
+    EpdRam::SendCommand(command);
 }
 
 /******************************************************************************
-function :	Wait until the busy_pin goes LOW
+function :	Wait until BUSY goes LOW
 parameter:
+return   :	0 when idle, EPD_ERR_TIMEOUT if BUSY stayed HIGH
 ******************************************************************************/
-void Epd::WaitUntilIdle(void)
+int Epd::WaitUntilIdle(void)
 {
-    while(1) {      //LOW: idle, HIGH: busy
-        if(DigitalRead(busy_pin) == 0)
-            break;
-        DelayMs(10);
-    }
+    return WaitBusyIdle(EPD_BUSY_TIMEOUT_MS);   //LOW: idle, HIGH: busy
 }
 
 /******************************************************************************
@@ -139,6 +267,16 @@ parameter:
 ******************************************************************************/
 void Epd::SetWindows(unsigned char Xstart, unsigned char Ystart, unsigned char Xend, unsigned char Yend)
 {
+    if (window_known && window[0] == Xstart && window[1] == Ystart &&
+        window[2] == Xend && window[3] == Yend) {
+        return;
+    }
+    window_known = true;
+    window[0] = Xstart;
+    window[1] = Ystart;
+    window[2] = Xend;
+    window[3] = Yend;
+
     SendCommand(0x44); // SET_RAM_X_ADDRESS_START_END_POSITION
     SendData((Xstart>>3) & 0xFF);
     SendData((Xend>>3) & 0xFF);
@@ -158,12 +296,42 @@ parameter:
 ******************************************************************************/
 void Epd::SetCursor(unsigned char Xstart, unsigned char Ystart)
 {
+    if (cursor_known && cursor[0] == Xstart && cursor[1] == Ystart) {
+        return;
+    }
+
     SendCommand(0x4E); // SET_RAM_X_ADDRESS_COUNTER
     SendData(Xstart & 0xFF);
 
     SendCommand(0x4F); // SET_RAM_Y_ADDRESS_COUNTER
     SendData(Ystart & 0xFF);
     SendData((Ystart >> 8) & 0xFF);
+
+    cursor_known = true;
+    cursor[0] = Xstart;
+    cursor[1] = Ystart;
+}
+
+/******************************************************************************
+function :	RAM window over byte columns xb..xb+wb-1 and rows y..y+h-1 with the
+            address counter at its top left, for the shared RAM access
+            (EpdRam); goes through the SetWindows()/SetCursor() shadow
+parameter:
+******************************************************************************/
+void Epd::SetRamWindow(int xb, int y, int wb, int h)
+{
+    int x1 = ((xb + wb) << 3) - 1;
+    SetWindows(xb << 3, y, x1 < EPD_WIDTH ? x1 : EPD_WIDTH - 1, y + h - 1);
+    SetCursor(xb, y);
+}
+
+/******************************************************************************
+function :	Address counter to the start of row y, for EpdRam
+parameter:
+******************************************************************************/
+void Epd::SetCursorRow(int y)
+{
+    SetCursor(0, y);
 }
 
 /******************************************************************************
@@ -173,24 +341,115 @@ parameter:
 ******************************************************************************/
 void Epd::Lut(const unsigned char *lut)
 {
-	unsigned char count;
-	SendCommand(0x32);
-	for(count = 0; count < 153; count++) {
-		SendData(lut[count]);
+	if (lut == lut_loaded) {
+		return;
 	}
+	lut_loaded = lut;
+
+	SendCommandData(0x32, lut, 153);
 
 	SendCommand(0x3f);
 	SendData(*(lut+153));
 	SendCommand(0x03);	// gate voltage
 	SendData(*(lut+154));
-	SendCommand(0x04);	// source voltage
-	SendData(*(lut+155));	// VSH
-	SendData(*(lut+156));	// VSH2
-	SendData(*(lut+157));	// VSL
+	SendCommandData(0x04, lut+155, 3);	// source voltage: VSH, VSH2, VSL
 	SendCommand(0x2c);		// VCOM
 	SendData(*(lut+158));
 }
 
+/******************************************************************************
+function :	Read the controller's internal temperature sensor (0x1B). Needs
+            the panel SDA line wired to MISO, see SpiReadBlock(); without it
+            the reading stays EPD_TEMP_UNKNOWN. With EPD_READ_TEMP, Init()
+            and the refreshes call this every EPD_TEMP_PERIOD_MS and pick
+            the LUTs for the band. 0x0000 (MISO low) and readings outside
+            EPD_TEMP_MIN..EPD_TEMP_MAX count as unknown, which selects the
+            room temperature band.
+parameter:
+return   :	temperature in degC, or EPD_TEMP_UNKNOWN
+******************************************************************************/
+int Epd::ReadTemperature(void)
+{
+    unsigned char raw[2];
+    unsigned long write_clock = GetSpiClock();
+
+    RunSequence(seq_load_temp, EPD_BUSY_TIMEOUT_MS);
+    lut_loaded = NULL;
+
+    SetSpiClock(EPD_SPI_CLOCK_READ);
+    SendCommand(0x1B);
+    ReadData(raw, 2);
+    SetSpiClock(write_clock);
+
+    temp_read_at = millis();
+    temp_valid = true;
+    /* 12-bit two's complement in 1/16 degC, MSB first; all ones or all
+       zeros = MISO floating high or low */
+    int value = (raw[0] << 4) | (raw[1] >> 4);
+    if (value & 0x800) {
+        value -= 0x1000;
+    }
+    value /= 16;
+    if ((raw[0] == 0xFF && raw[1] == 0xFF) || (raw[0] == 0x00 && raw[1] == 0x00) ||
+        value < EPD_TEMP_MIN || value > EPD_TEMP_MAX) {
+        temperature = EPD_TEMP_UNKNOWN;
+    } else {
+        temperature = value;
+    }
+    return temperature;
+}
+
+/******************************************************************************
+function :	Last temperature read by Init() or ReadTemperature()
+parameter:
+return   :	temperature in degC, or EPD_TEMP_UNKNOWN
+******************************************************************************/
+int Epd::Temperature(void)
+{
+    return temperature;
+}
+
+/******************************************************************************
+function :	Whether the temperature reading is older than EPD_TEMP_PERIOD_MS.
+            Never without EPD_READ_TEMP: the room temperature band is used.
+parameter:
+******************************************************************************/
+bool Epd::TemperatureDue(void)
+{
+#if EPD_READ_TEMP
+    return !temp_valid || millis() - temp_read_at >= EPD_TEMP_PERIOD_MS;
+#else
+    return false;
+#endif
+}
+
+/******************************************************************************
+function :	LUT band for the last temperature reading
+parameter:
+******************************************************************************/
+const LutBand* Epd::Band(void)
+{
+    if (temperature == EPD_TEMP_UNKNOWN) {
+        return &lut_bank[LUT_BAND_DEFAULT];
+    }
+    int band = 0;
+    for (unsigned int i = 1; i < sizeof(lut_bank) / sizeof(lut_bank[0]); i++) {
+        if (temperature >= lut_bank[i].min_c) {
+            band = i;
+        }
+    }
+    return &lut_bank[band];
+}
+
+/******************************************************************************
+function :	LUT the current mode refreshes with, for the last temperature
+parameter:
+******************************************************************************/
+const unsigned char* Epd::ModeLut(void)
+{
+    return mode == PART ? Band()->part : Band()->full;
+}
+
 /******************************************************************************
 function :	Initialize the e-Paper register
 parameter:
@@ -198,76 +457,65 @@ parameter:
 ******************************************************************************/
 int Epd::Init(char Mode)
 {
+    /* already set up for this mode: nothing to send, see Invalidate() */
+    if (Mode == mode) {
+        return 0;
+    }
+
     /* this calls the peripheral hardware interface, see epdif */
     if (IfInit() != 0) {
         return -1;
     }
     
-    Reset();
+    /* woken from deep sleep mode 1: the RAM still holds the last frame (and
+       the old image), the reset pulse of the PART path wakes it; the pulse
+       resets the registers, so seq_init_panel follows in both modes */
+    if (!(Mode == PART && asleep)) {
+        Reset();
+    }
+    asleep = false;
     
-    int count;
     if(Mode == FULL) {
         WaitUntilIdle();
-        SendCommand(0x12); // soft reset
-        WaitUntilIdle();
-
-        SendCommand(0x01); //Driver output control
-        SendData(0xF9);
-        SendData(0x00);
-        SendData(0x00);
-
-        SendCommand(0x11); //data entry mode
-        SendData(0x03);
-
-		SetWindows(0, 0, EPD_WIDTH-1, EPD_HEIGHT-1);
-		SetCursor(0, 0);
-		
-		SendCommand(0x3C); //BorderWavefrom
-		SendData(0x05);	
-
-		SendCommand(0x21); //  Display update control
-		SendData(0x00);
-		SendData(0x80);	
-
-		SendCommand(0x18); //Read built-in temperature sensor
-		SendData(0x80);	
-
-		WaitUntilIdle();
-		Lut(lut_full_update);
+        if (RunSequence(seq_init_full, EPD_BUSY_TIMEOUT_MS) != EPD_OK ||
+            RunSequence(seq_init_panel, EPD_BUSY_TIMEOUT_MS) != EPD_OK) {
+            return -1;
+        }
+        if (TemperatureDue()) {
+            ReadTemperature();
+        }
+		Lut(Band()->full);
     } else if(Mode == PART) {	
 	
-		DigitalWrite(reset_pin, LOW);                //module reset
+		RstPin::Low();                  //module reset
 		DelayMs(1);
-		DigitalWrite(reset_pin, HIGH);
-
-		Lut(lut_partial_update);
-		
-        SendCommand(0x37);
-        SendData(0x00);
-        SendData(0x00);
-        SendData(0x00);
-        SendData(0x00);
-		SendData(0x00);
-        SendData(0x40);
-        SendData(0x00);
-		SendData(0x00);
-		SendData(0x00);
-        SendData(0x00);
-
-		SendCommand(0x3C); //BorderWavefrom
-		SendData(0x80);	
-	
-		SendCommand(0x22); //Display Update Sequence Option
-		SendData(0xC0);    // Enable clock and  Enable analog
-		SendCommand(0x20);  //Activate Display Update Sequence
-		WaitUntilIdle();  
-		
-		SetWindows(0, 0, EPD_WIDTH-1, EPD_HEIGHT-1);
-		SetCursor(0, 0);
+		RstPin::High();
+		WaitUntilIdle();
+        if (RunSequence(seq_init_panel, EPD_BUSY_TIMEOUT_MS) != EPD_OK) {
+            return -1;
+        }
+
+		if (TemperatureDue()) {
+			ReadTemperature();
+		}
+		Lut(Band()->part);
+        if (RunSequence(seq_init_part, EPD_BUSY_TIMEOUT_MS) != EPD_OK) {
+            return -1;
+        }
     } else {
         return -1;
     }
 
+    /* both init tables end with the full window and the cursor at (0, 0) */
+    mode = Mode;
+    window_known = true;
+    window[0] = 0;
+    window[1] = 0;
+    window[2] = EPD_WIDTH - 1;
+    window[3] = EPD_HEIGHT - 1;
+    cursor_known = true;
+    cursor[0] = 0;
+    cursor[1] = 0;
     return 0;
 }
 
@@ -277,13 +525,14 @@ parameter:
 ******************************************************************************/
 void Epd::Reset(void)
 {
-    DigitalWrite(reset_pin, HIGH);
+    RstPin::High();
     DelayMs(20);
-    DigitalWrite(reset_pin, LOW);                //module reset
+    RstPin::Low();                  //module reset
     DelayMs(2);
-    DigitalWrite(reset_pin, HIGH);
+    RstPin::High();
     DelayMs(20);
-    this->count = 0; 
+    stream_rows = -1;
+    Invalidate();
 }
 
 /******************************************************************************
@@ -292,70 +541,145 @@ parameter:
 ******************************************************************************/
 void Epd::Clear(void)
 {
-    int w, h;
-    w = (EPD_WIDTH % 8 == 0)? (EPD_WIDTH / 8 ): (EPD_WIDTH / 8 + 1);
-    h = EPD_HEIGHT;
-    SendCommand(0x24);
-    for (int j = 0; j < h; j++) {
-        for (int i = 0; i < w; i++) {
-            SendData(0xff);
-        }
-    }
+    FillRam(0x24, 0xff);
 
     //DISPLAY REFRESH
-    SendCommand(0x22);
-    SendData(0xC7);
-    SendCommand(0x20);
-    WaitUntilIdle();
+    RefreshFull(EPD_QUALITY_HIGH);
+
+    if (pingpong || old_stale) {
+        FillRam(0x26, 0xff);
+        old_stale = false;
+    }
 }
 
 /******************************************************************************
 function :	Sends the image buffer in RAM to e-Paper and displays
 parameter:
 	frame_buffer : Image data
+	quality : EPD_QUALITY_HIGH for the uploaded full LUT, EPD_QUALITY_FAST
+	          for the shorter OTP waveform (less contrast, some ghosting;
+	          meant for interactive pushes, not the periodic cleaning refresh)
 ******************************************************************************/
-void Epd::Display(const unsigned char* frame_buffer)
+void Epd::Display(const unsigned char* frame_buffer, int quality)
 {
     int w = (EPD_WIDTH % 8 == 0)? (EPD_WIDTH / 8 ): (EPD_WIDTH / 8 + 1);
     int h = EPD_HEIGHT;
 
-    if (frame_buffer != NULL) {
-        SendCommand(0x24);
-        for (int j = 0; j < h; j++) {
-            for (int i = 0; i < w; i++) {
-                SendData(pgm_read_byte(&frame_buffer[i + j * w]));
-            }
-        }
+    if (frame_buffer != NULL && readback_diff) {
+        WriteChangedRows(0x24, frame_buffer);
+    } else if (frame_buffer != NULL) {
+        SetWindows(0, 0, EPD_WIDTH - 1, EPD_HEIGHT - 1);
+        SetCursor(0, 0);
+        SendCommandData(0x24, frame_buffer, w * h);
     }
 
     //DISPLAY REFRESH
-    SendCommand(0x22);
-    SendData(0xC7);
-    SendCommand(0x20);
-    WaitUntilIdle();
+    RefreshFull(quality);
+
+    if (frame_buffer != NULL && (pingpong || old_stale)) {
+        SyncOldImage(frame_buffer);
+    }
 }
 
 
 
-void Epd::Display1(const unsigned char* frame_buffer) {
-    if(this->count == 0){
-        SendCommand(0x24);
-        this->count++;
-    }else if(this->count > 0 && this->count < 4 ){
-        this->count++;
+/******************************************************************************
+function :	Start streaming a frame into one RAM plane, top row first. The
+            frame is then sent in bands of any height with WriteRows(), so
+            no full frame buffer is needed, and finished with EndFrame().
+            With SetPingPong() a frame streamed for a full refresh is not
+            copied into 0x26: stream it again into EPD_PLANE_RED afterwards.
+parameter:
+    plane : EPD_PLANE_BW, or EPD_PLANE_RED for the old image
+return   :	0, or -1 for an unknown plane
+******************************************************************************/
+int Epd::BeginFrame(unsigned char plane)
+{
+    return BeginRows(plane);
+}
+
+/******************************************************************************
+function :	Finish the streamed frame. Rows that were not sent keep their
+            previous RAM content.
+parameter:
+    refresh : EPD_REFRESH_FULL, EPD_REFRESH_PART, or EPD_REFRESH_NONE to
+              only finish the plane
+return   :	0, or -1 if no frame is being streamed
+******************************************************************************/
+int Epd::EndFrame(int refresh)
+{
+    if (EndRows() != 0) {
+        return -1;
     }
-    for(int i = 0; i < this->bufwidth * this->bufheight; i++){
-            SendData(frame_buffer[i]);
+    if (refresh == EPD_REFRESH_FULL) {
+        RefreshFull(EPD_QUALITY_HIGH);
+    } else if (refresh == EPD_REFRESH_PART) {
+        RefreshPart();
     }
-    if(this->count == 4){
-        SendCommand(0x22);
-        SendData(0xC7);
-        SendCommand(0x20);
-        WaitUntilIdle();
-        this->count = 0;
+    return 0;
+}
+
+/******************************************************************************
+function :	Split one row of a 2 bits per pixel frame into one RAM plane row.
+            The high bit of every pixel goes to 0x24, the low bit to 0x26.
+parameter:
+    gray : EPD_GRAY_ROW_BYTES bytes, 4 pixels per byte MSB first
+    plane : EPD_ROW_BYTES bytes out
+    bit : 1 for the 0x24 plane, 0 for 0x26
+******************************************************************************/
+static void GrayRowToPlane(const unsigned char* gray, unsigned char* plane, int bit)
+{
+    for (int i = 0; i < EPD_ROW_BYTES; i++) {
+        unsigned char hi = gray[2 * i];
+        unsigned char lo = gray[2 * i + 1];
+        unsigned char out = 0;
+        for (int p = 0; p < 4; p++) {
+            out |= ((hi >> (6 - 2 * p + bit)) & 1) << (7 - p);
+            out |= ((lo >> (6 - 2 * p + bit)) & 1) << (3 - p);
+        }
+        plane[i] = out;
     }
 }
 
+/******************************************************************************
+function :	Show a 4-gray frame with a full refresh. Each row is split into the
+            0x24 and 0x26 planes while it is sent, so no second buffer is
+            needed. Call after Init(FULL). 0x26 no longer holds an old image
+            afterwards: the next Clear(), Display() or DisplayPartBaseImage()
+            writes it again, partial refreshes need one of them first.
+parameter:
+	gray_buffer : 2 bits per pixel, EPD_GRAY_ROW_BYTES per row,
+	              GRAY_BLACK (0) ... GRAY_WHITE (3), see epdpaint.h
+******************************************************************************/
+void Epd::DisplayGray4(const unsigned char* gray_buffer)
+{
+    unsigned char row[EPD_ROW_BYTES];
+
+    if (gray_buffer == NULL) {
+        return;
+    }
+    SetWindows(0, 0, EPD_WIDTH - 1, EPD_HEIGHT - 1);
+    SetCursor(0, 0);
+    SendCommand(0x24);
+    for (int y = 0; y < EPD_HEIGHT; y++) {
+        GrayRowToPlane(gray_buffer + y * EPD_GRAY_ROW_BYTES, row, 1);
+        SendDataBlock(row, EPD_ROW_BYTES);
+    }
+    SetCursor(0, 0);
+    SendCommand(0x26);
+    for (int y = 0; y < EPD_HEIGHT; y++) {
+        GrayRowToPlane(gray_buffer + y * EPD_GRAY_ROW_BYTES, row, 0);
+        SendDataBlock(row, EPD_ROW_BYTES);
+    }
+
+    /* lut_gray4 stays loaded until the next refresh puts the mode LUT
+       back, and 0x26 holds the low bits, not an old image */
+    Lut(lut_gray4);
+    SetBusyMode(EPD_BUSY_FULL);
+    RunSequence(seq_refresh_full, EPD_BUSY_TIMEOUT_MS);
+    old_stale = true;
+}
+
 /******************************************************************************
 function :	Refresh a base image
 parameter:
@@ -367,26 +691,18 @@ void Epd::DisplayPartBaseImage(const unsigned char* frame_buffer)
     int h = EPD_HEIGHT;
 
     if (frame_buffer != NULL) {
-        SendCommand(0x24);
-        for (int j = 0; j < h; j++) {
-            for (int i = 0; i < w; i++) {
-                SendData(pgm_read_byte(&frame_buffer[i + j * w]));
-            }
-        }
-
-        SendCommand(0x26);
-        for (int j = 0; j < h; j++) {
-            for (int i = 0; i < w; i++) {
-                SendData(pgm_read_byte(&frame_buffer[i + j * w]));
-            }
-        }
+        SetWindows(0, 0, EPD_WIDTH - 1, EPD_HEIGHT - 1);
+        SetCursor(0, 0);
+        SendCommandData(0x24, frame_buffer, w * h);
+
+        SetWindows(0, 0, EPD_WIDTH - 1, EPD_HEIGHT - 1);
+        SetCursor(0, 0);
+        SendCommandData(0x26, frame_buffer, w * h);
+        old_stale = false;
     }
 
     //DISPLAY REFRESH
-    SendCommand(0x22);
-    SendData(0xC7);
-    SendCommand(0x20);
-    WaitUntilIdle();
+    RefreshFull(EPD_QUALITY_HIGH);
 }
 
 /******************************************************************************
@@ -399,20 +715,80 @@ void Epd::DisplayPart(const unsigned char* frame_buffer)
     int w = (EPD_WIDTH % 8 == 0)? (EPD_WIDTH / 8 ): (EPD_WIDTH / 8 + 1);
     int h = EPD_HEIGHT;
 
-    if (frame_buffer != NULL) {
-        SendCommand(0x24);
-        for (int j = 0; j < h; j++) {
-            for (int i = 0; i < w; i++) {
-                SendData(pgm_read_byte(&frame_buffer[i + j * w]));
-            }
-        }
+    if (frame_buffer != NULL && readback_diff) {
+        WriteChangedRows(0x24, frame_buffer);
+    } else if (frame_buffer != NULL) {
+        SetWindows(0, 0, EPD_WIDTH - 1, EPD_HEIGHT - 1);
+        SetCursor(0, 0);
+        SendCommandData(0x24, frame_buffer, w * h);
     }
 
     //DISPLAY REFRESH
-    SendCommand(0x22);
-    SendData(0x0f);
-    SendCommand(0x20);
-    WaitUntilIdle();
+    RefreshPart();
+}
+
+/******************************************************************************
+function :	Partial refresh of a rectangle. Only the bytes inside it are taken
+            from the full-size frame buffer and written through a RAM window
+            of the same size, the rest of the RAM keeps the previous frame.
+parameter:
+	frame_buffer : full frame, EPD_ROW_BYTES per row
+	x : left edge in pixels, rounded down to a multiple of 8
+	y : top row
+	w : width in pixels, the right edge is rounded up to a whole byte
+	h : number of rows
+******************************************************************************/
+void Epd::DisplayPartWindow(const unsigned char* frame_buffer, int x, int y, int w, int h)
+{
+    WritePartWindow(frame_buffer, x, y, w, h);
+    RefreshPart();
+}
+
+/******************************************************************************
+function :	Write a rectangle of the frame to RAM 0x24 without refreshing, so
+            several windows can share one RefreshPart()
+parameter:
+	same as DisplayPartWindow
+******************************************************************************/
+void Epd::WritePartWindow(const unsigned char* frame_buffer, int x, int y, int w, int h)
+{
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (x + w > EPD_WIDTH) {
+        w = EPD_WIDTH - x;
+    }
+    if (y + h > EPD_HEIGHT) {
+        h = EPD_HEIGHT - y;
+    }
+    if (frame_buffer == NULL || w <= 0 || h <= 0) {
+        return;
+    }
+
+    int xb = x >> 3;
+    int wb = ((x + w - 1) >> 3) - xb + 1;
+
+    WriteWindow(0x24, frame_buffer + y * EPD_ROW_BYTES + xb, EPD_ROW_BYTES, xb, y, wb, h);
+}
+
+/******************************************************************************
+function :	Partial refresh of whatever RAM 0x24 holds now. The controller's
+            RAM ping-pong (seq_init_part) then keeps it as the old image.
+parameter:
+******************************************************************************/
+void Epd::RefreshPart(void)
+{
+    if (TemperatureDue()) {
+        ReadTemperature();      // an awake panel never sees Init() again
+    }
+    Lut(ModeLut());
+    SetBusyMode(EPD_BUSY_PART);
+    RunSequence(seq_refresh_part, EPD_BUSY_TIMEOUT_MS);
 }
 
 /******************************************************************************
@@ -421,34 +797,104 @@ parameter:
 ******************************************************************************/
 void Epd::ClearPart(void)
 {
-    int w, h;
-    w = (EPD_WIDTH % 8 == 0)? (EPD_WIDTH / 8 ): (EPD_WIDTH / 8 + 1);
-    h = EPD_HEIGHT;
-    SendCommand(0x24);
-    for (int j = 0; j < h; j++) {
-        for (int i = 0; i < w; i++) {
-            SendData(0xff);
+    FillRam(0x24, 0xff);
+
+    //DISPLAY REFRESH
+    RefreshPart();
+}
+
+/******************************************************************************
+function :	Full refresh of what is in RAM. Every full refresh goes through
+            here (and every partial one through RefreshPart()), so the LUT
+            always matches the current mode and quality: a fast refresh runs
+            the OTP waveform with the forced temperature and drops the
+            uploaded LUT, a 4-gray one leaves lut_gray4 loaded, the next
+            refresh uploads the mode LUT again (Lut() sends nothing while it
+            is still loaded). The temperature is read again here once
+            EPD_TEMP_PERIOD_MS have passed, Init() alone would miss it while
+            the panel stays awake in one mode.
+parameter:
+    quality : EPD_QUALITY_HIGH or EPD_QUALITY_FAST
+******************************************************************************/
+void Epd::RefreshFull(int quality)
+{
+    if (quality == EPD_QUALITY_FAST) {
+        RunSequence(seq_fast_full, EPD_BUSY_TIMEOUT_MS);
+        lut_loaded = NULL;      // the OTP waveform replaced the uploaded LUT
+        SetBusyMode(EPD_BUSY_FAST);
+    } else {
+        if (TemperatureDue()) {
+            ReadTemperature();
         }
+        Lut(ModeLut());
+        SetBusyMode(EPD_BUSY_FULL);
     }
+    RunSequence(seq_refresh_full, EPD_BUSY_TIMEOUT_MS);
+}
 
-    //DISPLAY REFRESH
-    SendCommand(0x22);
-    SendData(0x0f);
-    SendCommand(0x20);
-    WaitUntilIdle();
+/******************************************************************************
+function :	Forget the shadowed controller state. The next Init() then runs in
+            full and the next Lut()/SetWindows()/SetCursor() are sent again.
+            Call it after talking to the controller behind the driver's back.
+parameter:
+******************************************************************************/
+void Epd::Invalidate(void)
+{
+    mode = EPD_MODE_NONE;
+    lut_loaded = NULL;
+    window_known = false;
+    cursor_known = false;
 }
 
 /******************************************************************************
-function :	Enter sleep mode
+function :	Enable or disable writing RAM 0x26 after full refreshes. Partial
+            refreshes compare 0x24 against the "old image" in 0x26, and the
+            controller's RAM ping-pong (on in seq_init_part) keeps 0x26 up to
+            date from one partial refresh to the next, but a full refresh
+            leaves it alone. With this on, Display() and Clear() also write
+            the frame just shown to 0x26, so PART mode can start right after
+            them without DisplayPartBaseImage().
+parameter:
+    enable : true to write 0x26 after full refreshes
+******************************************************************************/
+void Epd::SetPingPong(bool enable)
+{
+    pingpong = enable;
+}
+
+/******************************************************************************
+function :	Copy a whole frame into 0x26 after a full refresh displayed it
+parameter:
+    frame_buffer : full frame, EPD_ROW_BYTES per row
+******************************************************************************/
+void Epd::SyncOldImage(const unsigned char* frame_buffer)
+{
+    if (readback_diff) {
+        WriteChangedRows(0x26, frame_buffer);
+    } else {
+        SetWindows(0, 0, EPD_WIDTH - 1, EPD_HEIGHT - 1);
+        SetCursor(0, 0);
+        SendCommandData(0x26, frame_buffer, EPD_ROW_BYTES * EPD_HEIGHT);
+    }
+    old_stale = false;
+}
+
+/******************************************************************************
+function :	Enter deep sleep mode 1. The controller registers are lost but the
+            RAM is kept, so the next Init(PART) skips the full Reset() and
+            the next partial refresh only needs the changed window. Waking
+            costs the reset pulse, the LUT and seq_init_part, so only sleep
+            when the next update is far away. RST stays high, holding the
+            controller in reset is not the RAM-retaining sleep mode.
 parameter:
 ******************************************************************************/
 void Epd::Sleep()
 {
-    SendCommand(0x10); //enter deep sleep
+    WaitUntilIdle();   //let a running refresh finish, BUSY stays high once asleep
+    SendCommand(0x10); //enter deep sleep mode 1, RAM is retained
     SendData(0x01);
-    DelayMs(200);
-
-    DigitalWrite(reset_pin, LOW);
+    Invalidate();       // mode too: the next Init() runs in full
+    asleep = true;
 }
 
 /* END OF FILE */
@@ -31,46 +31,106 @@
 #ifndef epd2in13_V3
 #define epd2in13_V3
 
-#include "epdif.h"
+#include "epdram.h"
 
 // Display resolution
 #define EPD_WIDTH       122
 #define EPD_HEIGHT      250
 
+// Fastest SPI write clock the SSD1680 accepts (50 ns SCL write cycle)
+#define EPD_SPI_CLOCK_MAX       20000000
+
+// Longest BUSY period (full refresh) before WaitUntilIdle gives up
+#define EPD_BUSY_TIMEOUT_MS     10000
+
+// Bytes per RAM row
+#define EPD_ROW_BYTES   ((EPD_WIDTH + 7) / 8)
+
+// Bytes per row of a 2 bits per pixel frame for DisplayGray4()
+#define EPD_GRAY_ROW_BYTES  (EPD_ROW_BYTES * 2)
+
 #define FULL			0
 #define PART			1
+#define EPD_MODE_NONE	-1      // controller state unknown (after reset/sleep)
+
+// Display() refresh quality
+#define EPD_QUALITY_HIGH    0   // uploaded full LUT, about 2 s
+#define EPD_QUALITY_FAST    1   // OTP waveform for 100 degC, see seq_fast_full
+
+// Temperature handling (EPD_READ_TEMP): readings are refreshed by Init() and
+// before each refresh at most this often, and below EPD_TEMP_COLD degC the
+// slower partial waveform is used
+#define EPD_TEMP_PERIOD_MS      60000
+#define EPD_TEMP_COLD           10
+#define EPD_TEMP_UNKNOWN        -128
+// Operating range of the sensor; readings outside it are not trusted
+#define EPD_TEMP_MIN            -40
+#define EPD_TEMP_MAX            85
 
-class Epd : EpdIf {
+struct LutBand;
+
+class Epd : public EpdRam {
 public:
     unsigned long width;
     unsigned long height;
-    int bufwidth;
-    int bufheight;
-    int count;
 
     Epd();
     ~Epd();
     int  Init(char Mode);
     void SendCommand(unsigned char command);
-    void SendData(unsigned char data);
-    void WaitUntilIdle(void);
+    void SetPingPong(bool enable);
+    int  ReadTemperature(void);
+    int  Temperature(void);
+    void Invalidate(void);
+    int  WaitUntilIdle(void);
 	void SetWindows(unsigned char Xstart, unsigned char Ystart, unsigned char Xend, unsigned char Yend);
 	void SetCursor(unsigned char Xstart, unsigned char Ystart);
 	void Lut(const unsigned char* lut);
     void Reset(void);
     void Clear(void);
-    void Display(const unsigned char* frame_buffer);
-    void Display1(const unsigned char* frame_buffer);
+    void Display(const unsigned char* frame_buffer, int quality = EPD_QUALITY_HIGH);
+    int  BeginFrame(unsigned char plane);
+    int  EndFrame(int refresh);
+    void DisplayGray4(const unsigned char* gray_buffer);
     void DisplayPartBaseImage(const unsigned char* frame_buffer);
     void DisplayPart(const unsigned char* frame_buffer);
+    void DisplayPartWindow(const unsigned char* frame_buffer, int x, int y, int w, int h);
+    void WritePartWindow(const unsigned char* frame_buffer, int x, int y, int w, int h);
+    void RefreshPart(void);
     void ClearPart(void);
     
     void Sleep(void);
 private:
-    unsigned int reset_pin;
-    unsigned int dc_pin;
-    unsigned int cs_pin;
-    unsigned int busy_pin;
+    // addressing for the EpdRam RAM access, through the shadow below
+    void SetRamWindow(int xb, int y, int wb, int h);
+    void SetCursorRow(int y);
+    void RefreshFull(int quality);
+    void SyncOldImage(const unsigned char* frame_buffer);
+
+    // last temperature reading and the millis() it was taken at
+    bool TemperatureDue(void);
+    const LutBand* Band(void);
+    const unsigned char* ModeLut(void);
+    int temperature;
+    unsigned long temp_read_at;
+    bool temp_valid;
+
+    // in deep sleep mode 1: registers lost, RAM kept, Init(PART) can skip Reset()
+    bool asleep;
+
+    // write 0x26 after full refreshes, see SetPingPong()
+    bool pingpong;
+    // 0x26 holds 4-gray data, the next full refresh writes it regardless
+    bool old_stale;
+
+    // Shadow of the controller state, so repeated Init()/Lut()/SetWindows()/
+    // SetCursor() calls with unchanged values send nothing
+    char mode;
+    const unsigned char* lut_loaded;
+    bool window_known;
+    unsigned char window[4];
+    bool cursor_known;
+    unsigned char cursor[2];
 };
 
 #endif /* EPD2IN13_V3_H */
@@ -8,11 +8,12 @@
 
 /**
   * Due to RAM not enough in Arduino UNO, a frame buffer is not allowed.
-  * In this case, a smaller image buffer is allocated and you have to 
-  * update a partial display several times.
-  * 1 byte = 8 pixels, therefore you have to set 8*N pixels at a time.
+  * In this case, a smaller image buffer is allocated and the frame is
+  * streamed to the panel one band at a time (BeginFrame/WriteRows/EndFrame).
+  * A band is EPD_ROW_BYTES * 8 pixels wide and may have any height.
   */
-unsigned char image[1050];
+#define BAND_HEIGHT 63
+unsigned char image[EPD_ROW_BYTES * BAND_HEIGHT];
 Paint paint(image, 0, 0);
 Epd epd;
 
@@ -26,12 +27,14 @@ void setup()
 
   delay(2000);
 
-  Paint paint(image, epd.bufwidth*8, epd.bufheight);    //width should be the multiple of 8
+  Paint paint(image, EPD_ROW_BYTES * 8, BAND_HEIGHT);    //width should be the multiple of 8
+
+  epd.BeginFrame(EPD_PLANE_BW);
 
   paint.Clear(UNCOLORED);
   paint.DrawStringAt(8, 2, "e-Paper Demo", &Font12, COLORED);
   paint.DrawStringAt(8, 20, "Hello world", &Font12, COLORED);
-  epd.Display1(image);//1
+  epd.WriteRows(image, BAND_HEIGHT);//1
 
   paint.Clear(UNCOLORED);
   paint.DrawRectangle(2,2,50,50,COLORED);
@@ -40,15 +43,16 @@ void setup()
   paint.DrawFilledRectangle(52,2,100,50,COLORED);
   paint.DrawLine(52,2,100,50,UNCOLORED);
   paint.DrawLine(100,2,52,50,UNCOLORED);
-  epd.Display1(image);//2
+  epd.WriteRows(image, BAND_HEIGHT);//2
   
   paint.Clear(UNCOLORED);
   paint.DrawCircle(25,25,20,COLORED);
   paint.DrawFilledCircle(75,25,20,COLORED);
-  epd.Display1(image);//3
+  epd.WriteRows(image, BAND_HEIGHT);//3
   
   paint.Clear(UNCOLORED);
-  epd.Display1(image);//4
+  epd.WriteRows(image, BAND_HEIGHT);//4, the last band is cut to the panel height
+  epd.EndFrame(EPD_REFRESH_FULL);
 
   delay(2000);
 
@@ -29,6 +29,7 @@
 
 Paint::Paint(unsigned char* image, int width, int height) {
     this->rotate = ROTATE_0;
+    this->bpp = 1;
     this->image = image;
     /* 1 byte = 8 pixels, so the width should be the multiple of 8 */
     this->width = width % 8 ? width + 8 - (width % 8) : width;
@@ -57,6 +58,13 @@ void Paint::DrawAbsolutePixel(int x, int y, int colored) {
     if (x < 0 || x >= this->width || y < 0 || y >= this->height) {
         return;
     }
+    if (this->bpp == 2) {
+        unsigned char* p = &image[(x + y * this->width) / 4];
+        int shift = 6 - 2 * (x % 4);
+        int level = (IF_INVERT_COLOR ? colored : GRAY_WHITE - colored) & 0x03;
+        *p = (*p & ~(0x03 << shift)) | (level << shift);
+        return;
+    }
     if (IF_INVERT_COLOR) {
         if (colored) {
             image[(x + y * this->width) / 8] |= 0x80 >> (x % 8);
@@ -103,6 +111,19 @@ void Paint::SetRotate(int rotate){
     this->rotate = rotate;
 }
 
+int Paint::GetBitsPerPixel(void) {
+    return this->bpp;
+}
+
+/**
+ *  @brief: 1 = one bit per pixel (colored is 0 or 1), 2 = four gray levels
+ *          (colored is GRAY_BLACK ... GRAY_WHITE). The buffer then needs
+ *          width / 4 bytes per row.
+ */
+void Paint::SetBitsPerPixel(int bpp) {
+    this->bpp = bpp == 2 ? 2 : 1;
+}
+
 /**
  *  @brief: this draws a pixel by the coordinates
  */
@@ -391,6 +412,23 @@ void Paint::DrawImage(int x, int y, int width, int height, const unsigned char*
     }
 }
 
+/**
+ *  @brief: this draws a 2 bits per pixel image (4 pixels per byte, MSB
+ *          first, GRAY_BLACK ... GRAY_WHITE) on the frame buffer but not
+ *          refresh. Needs SetBitsPerPixel(2).
+ */
+void Paint::DrawGrayImage(int x, int y, int width, int height, const unsigned char* image_data) {
+    int width_in_bytes = (width + 3) / 4;
+
+    for (int j = 0; j < height; j++) {
+        const unsigned char* row = image_data + j * width_in_bytes;
+        for (int i = 0; i < width; i++) {
+            unsigned char data = pgm_read_byte(row + i / 4);
+            DrawPixel(x + i, y + j, (data >> (6 - 2 * (i % 4))) & 0x03);
+        }
+    }
+}
+
 
 
 
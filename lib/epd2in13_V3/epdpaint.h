@@ -36,6 +36,13 @@
 // Color inverse. 1 or 0 = set or reset a bit if set a colored pixel
 #define IF_INVERT_COLOR     1
 
+// Gray levels for 2 bits per pixel (SetBitsPerPixel(2)), 4 pixels per byte
+// MSB first; pass them as the colored argument of the drawing functions
+#define GRAY_BLACK          0
+#define GRAY_DARK           1
+#define GRAY_LIGHT          2
+#define GRAY_WHITE          3
+
 #include "fonts.h"
 
 class Paint {
@@ -49,6 +56,8 @@ public:
     void SetHeight(int height);
     int  GetRotate(void);
     void SetRotate(int rotate);
+    int  GetBitsPerPixel(void);
+    void SetBitsPerPixel(int bpp);
     unsigned char* GetImage(void);
     void DrawAbsolutePixel(int x, int y, int colored);
     void DrawPixel(int x, int y, int colored);
@@ -65,12 +74,14 @@ public:
     void DrawChinese(int x, int y, int index, sFONT* font, int colored);
     // 在 DrawStringAt 下面添加这一行
     void DrawImage(int x, int y, int width, int height, const unsigned char* image_data, int colored);
+    void DrawGrayImage(int x, int y, int width, int height, const unsigned char* image_data);
 
 private:
     unsigned char* image;
     int width;
     int height;
     int rotate;
+    int bpp;
 };
 
 #endif
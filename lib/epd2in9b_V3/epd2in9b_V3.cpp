@@ -25,19 +25,109 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "epd2in9b_V3.h"
 #include "imagedata.h"
 
+/* 控制器命令表 (格式见 epdseq.h): 命令, 长度 [| 等待 BUSY], 参数 */
+static constexpr unsigned char seq_init[] = {
+    // 软件复位 (SWRESET)
+    0x12, 0 | EPD_SEQ_WAIT,
+    // 驱动输出控制 (Driver Output Control)
+    0x01, 3, (EPD_HEIGHT - 1) & 0xFF, (EPD_HEIGHT - 1) >> 8, 0x00,
+    // 数据进入模式: 0x01 = X轴递增, Y轴递减 (佳显驱动默认设置)
+    0x11, 1, 0x01,
+    // RAM X 地址窗口: 0 到 15 (128像素/8 = 16字节)
+    0x44, 2, 0x00, (EPD_WIDTH / 8) - 1,
+    // RAM Y 地址窗口: 295 到 0 (因为是Y递减模式)
+    0x45, 4, (EPD_HEIGHT - 1) & 0xFF, (EPD_HEIGHT - 1) >> 8, 0x00, 0x00,
+    // 波形边框 (Border Waveform)
+    0x3C, 1, 0x05,
+    // 显示更新控制 (Display Update Control)
+    0x21, 2, 0x00, 0x80,
+    // 读取内置温度传感器
+    0x18, 1, 0x80,
+    // RAM X / Y 地址计数器初始值
+    0x4E, 1, 0x00,
+    0x4F, 2 | EPD_SEQ_WAIT, (EPD_HEIGHT - 1) & 0xFF, (EPD_HEIGHT - 1) >> 8,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_init);
+
+// 三色全屏刷新 (0xF7)
+static constexpr unsigned char seq_refresh[] = {
+    0x22, 1, 0xF7,
+    0x20, 0 | EPD_SEQ_WAIT,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_refresh);
+
+// 黑白局刷波形 (SSD1680 LUT 格式，时序取自 2.13" V3 的局刷波形)。
+// 显示模式 1 下 VS L0 = 黑 (BW=0, R=0)，L1 = 白，L2..L4 = 红像素:
+// 红像素全部保持 VSS 不驱动，所以局刷不会动红色内容。
+// 只上传前 153 字节 (0x32)；末尾的 EOPT/VGH/VSH/VSL/VCOM 是 2.13" 屏的值，
+// 没有对这块屏核对过，电压一律用本屏 OTP 里的 (见 seq_load_otp)
+static const unsigned char lut_bw_partial[] = {
+    0x40,0x40,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,   // L0 黑: VSH1
+    0x80,0x80,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,   // L1 白: VSL
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x14,0x00,0x00,0x00,0x00,0x00,0x00,                             // TP/SR/RP 组 0
+    0x01,0x00,0x00,0x00,0x00,0x00,0x00,                             // 组 1
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x22,0x22,0x22,0x22,0x22,0x22,0x00,0x00,0x00,                   // FR, XON
+    0x22,0x17,0x41,0x00,0x32,0x36,                                  // EOPT VGH VSH1 VSH2 VSL VCOM
+};
+
+// 从 OTP 装载本屏的三色波形和电压 (0x22 = 0xB1: 开时钟、读温度、装载 LUT)。
+// 局刷前先装载，保证电压是本屏的；局刷后的第一次全刷前再装载一次，
+// 把上传的黑白波形换回三色波形，不依赖 0xF7 自己装载
+static constexpr unsigned char seq_load_otp[] = {
+    0x18, 1, 0x80,                              // 内部温度传感器
+    0x22, 1, 0xB1,
+    0x20, 0 | EPD_SEQ_WAIT,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_load_otp);
+
+// 黑白局刷: 边框浮空, 显示模式 1 使用上传的 LUT (不从 OTP 装载)
+static constexpr unsigned char seq_refresh_bw_part[] = {
+    0x3C, 1, 0x80,
+    0x22, 1, 0xC7,
+    0x20, 0 | EPD_SEQ_WAIT,
+    0x3C, 1, 0x05,                              // 恢复 seq_init 的边框波形
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_refresh_bw_part);
+
+#define PLANE_BYTES     (EPD_ROW_BYTES * EPD_HEIGHT)
+static_assert(EPD_ROW_BYTES <= EPD_RAM_MAX_ROW_BYTES && EPD_HEIGHT <= EPD_RAM_MAX_HEIGHT,
+              "panel larger than the epdram.h buffers");
+
+// DisplayFrameAsync() 状态
+#define ASYNC_IDLE      0
+#define ASYNC_BLACK     1
+#define ASYNC_RED       2
+#define ASYNC_REFRESH   3
+
 Epd::~Epd() {
 };
 
-Epd::Epd() {
-    reset_pin = RST_PIN;
-    dc_pin = DC_PIN;
-    cs_pin = CS_PIN;
-    busy_pin = BUSY_PIN;
+Epd::Epd() : EpdRam(EPD_ROW_BYTES, EPD_HEIGHT, EPD_SPI_CLOCK_MAX) {
     width = EPD_WIDTH / 8;
     height = EPD_HEIGHT;
+    async_stage = ASYNC_IDLE;
+    lut_uploaded = false;
 };
 
 int Epd::Init(void) {
@@ -48,90 +138,26 @@ int Epd::Init(void) {
 
     /* 2. 硬件复位 */
     Reset();
+    ForgetPlanes();
+    lut_uploaded = false;   // 复位后寄存器回到 OTP/上电值
     
-    /* 3. 软件复位 (SWRESET) */
-    WaitUntilIdle();
-    SendCommand(0x12); 
-    WaitUntilIdle();
-
-    /* 4. 驱动输出控制 (Driver Output Control) */
-    SendCommand(0x01);
-    SendData((EPD_HEIGHT - 1) & 0xFF);
-    SendData((EPD_HEIGHT - 1) >> 8);
-    SendData(0x00);
-
-    /* 5. 数据进入模式 (Data Entry Mode) */
-    // 0x01: X轴递增, Y轴递减 (佳显驱动默认设置)
-    SendCommand(0x11);
-    SendData(0x01);
-
-    /* 6. 设置 RAM X 地址窗口 (Set Ram-X Address Start/End) */
-    // X轴从 0 到 15 (128像素/8 = 16字节)
-    SendCommand(0x44);
-    SendData(0x00);
-    SendData((EPD_WIDTH / 8) - 1);
-
-    /* 7. 设置 RAM Y 地址窗口 (Set Ram-Y Address Start/End) */
-    // Y轴从 295 到 0 (因为是Y递减模式)
-    SendCommand(0x45);
-    SendData((EPD_HEIGHT - 1) & 0xFF);
-    SendData((EPD_HEIGHT - 1) >> 8);
-    SendData(0x00);
-    SendData(0x00);
-
-    /* 8. 设置波形边框 (Border Waveform) */
-    SendCommand(0x3C);
-    SendData(0x05);
-
-    /* 9. 显示更新控制 (Display Update Control) */
-    SendCommand(0x21);
-    SendData(0x00);
-    SendData(0x80);
-
-    /* 10. 读取内置温度传感器 */
-    SendCommand(0x18);
-    SendData(0x80);
-
-    /* 11. 设置 RAM X 地址计数器初始值 */
-    SendCommand(0x4E);
-    SendData(0x00);
-
-    /* 12. 设置 RAM Y 地址计数器初始值 */
-    SendCommand(0x4F);
-    SendData((EPD_HEIGHT - 1) & 0xFF);
-    SendData((EPD_HEIGHT - 1) >> 8);
-
+    /* 3. 等待空闲后执行 seq_init 命令表 (软件复位 ... RAM 计数器初始值) */
     WaitUntilIdle();
+    if (RunSequence(seq_init, EPD_BUSY_TIMEOUT_MS) != EPD_OK) {
+        return -1;
+    }
     return 0;
 }
 
 /**
- *  @brief: basic function for sending commands
- */
-void Epd::SendCommand(unsigned char command) {
-    DigitalWrite(dc_pin, LOW);
-    SpiTransfer(command);
-}
-
-/**
- *  @brief: basic function for sending data
- */
-void Epd::SendData(unsigned char data) {
-    DigitalWrite(dc_pin, HIGH);
-    SpiTransfer(data);
-}
-
-/**
- * @brief: Wait until the busy_pin goes LOW
+ * @brief: Wait until BUSY goes LOW
  * Good Display / SSD1680 Logic: HIGH = Busy, LOW = Idle
+ * @return: EPD_OK, or EPD_ERR_TIMEOUT
  */
-void Epd::WaitUntilIdle(void) {
-    Serial.println("e-Paper waiting for busy release...");
-    // 佳显逻辑：只要是高电平，就是忙，死循环等待
-    while(DigitalRead(busy_pin) == HIGH) {      
-        DelayMs(10); // 稍作延时，避免死锁 CPU
-    }      
-    Serial.println("e-Paper busy released!");
+int Epd::WaitUntilIdle(void) {
+    // 佳显逻辑：只要是高电平，就是忙；由 BUSY 下降沿中断唤醒，不再轮询
+    // 等待时间和超时由 WaitBusyIdle() 记入事件日志 (epdlog.h)，不再同步打印串口
+    return WaitBusyIdle(EPD_BUSY_TIMEOUT_MS);
 }
 
 /**
@@ -140,83 +166,301 @@ void Epd::WaitUntilIdle(void) {
  *          see Epd::Sleep();
  */
 void Epd::Reset(void) {
-    DigitalWrite(reset_pin, HIGH);
+    RstPin::High();
     DelayMs(200);   
-    DigitalWrite(reset_pin, LOW);                //module reset    
+    RstPin::Low();                  //module reset    
     DelayMs(2);
-    DigitalWrite(reset_pin, HIGH);
+    RstPin::High();
     DelayMs(200);    
 }
 
-void Epd::DisplayFrame(const UBYTE *blackimage, const UBYTE *ryimage) {
+/**
+ *  @brief: 写入两个平面并三色全刷
+ *  @param: black_hint, red_hint: 各平面的 EPD_HINT_*。默认 EPD_HINT_AUTO
+ *          扫描平面: 空白平面片上填充; EPD_HINT_HASH 时与上次写入相同的平面不再发送
+ */
+void Epd::DisplayFrame(const UBYTE *blackimage, const UBYTE *ryimage, int black_hint, int red_hint) {
     // 1. 发送黑白数据 (对应佳显驱动的 Write RAM 0x24)
-    SendCommand(0x24);
-    for (UWORD j = 0; j < height; j++) {
-        for (UWORD i = 0; i < width; i++) {
-            SendData(pgm_read_byte(&blackimage[i + (j * width)]));
-        }
-    }
+    WritePlane(0x24, blackimage, black_hint);
     
     // 2. 发送红色数据 (对应佳显驱动的 Write RAM 0x26)
-    SendCommand(0x26);
-    for (UWORD j = 0; j < height; j++) {
-        for (UWORD i = 0; i < width; i++) {
-            // 注意：佳显官方 Demo 在这里通常会取反(~)，那是针对特定图片格式的。
-            // 但因为你使用的是微雪 Paint 库 (0=有色/红色)，
-            // 而 SSD1680 芯片也是 (0=红色)，所以这里直接发送即可，不要取反。
-            SendData(pgm_read_byte(&ryimage[i + (j * width)]));
+    // 注意：佳显官方 Demo 在这里通常会取反(~)，那是针对特定图片格式的。
+    // 但因为你使用的是微雪 Paint 库 (0=有色/红色)，
+    // 而 SSD1680 芯片也是 (0=红色)，所以这里直接发送即可，不要取反。
+    // 大多数画面红色很少或没有：空白时片上填充 (见 WritePlane)
+    WritePlane(0x26, ryimage, red_hint);
+
+    // 3. 执行刷新 (对应佳显驱动的 Update)
+    // 0x22 = 0xF7: 标准全屏刷新 (0xC7 为快刷，但三色屏通常只能全刷), 0x20 激活刷新
+    RefreshTricolor();
+}
+
+/**
+ *  @brief: 三色全刷。DisplayPartBlack() 上传过黑白波形时先从 OTP
+ *          装载回三色波形和电压
+ */
+void Epd::RefreshTricolor(void) {
+    RestoreOtpLut();
+    SetBusyMode(EPD_BUSY_TRICOLOR);
+    RunSequence(seq_refresh, EPD_BUSY_TIMEOUT_MS);
+}
+
+/**
+ *  @brief: 上传过黑白局刷波形时从 OTP 装载回三色波形和电压
+ */
+void Epd::RestoreOtpLut(void) {
+    if (lut_uploaded) {
+        SetBusyMode(EPD_BUSY_OTHER);
+        RunSequence(seq_load_otp, EPD_BUSY_TIMEOUT_MS);
+        lut_uploaded = false;
+    }
+}
+
+/**
+ *  @brief: non-blocking DisplayFrame. Starts the black plane upload through
+ *          EasyDMA and returns; call DisplayFrameDone() from loop() until it
+ *          returns true. Returns -1 if a previous frame is still in progress.
+ */
+int Epd::DisplayFrameAsync(const UBYTE *blackimage, const UBYTE *ryimage) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
+    }
+    RestoreOtpLut();    // 阻塞几毫秒，DMA 开始之前做完
+    async_red = ryimage;
+    async_stage = ASYNC_BLACK;
+    ForgetPlanes();
+
+    if (blackimage == NULL) {
+        FillRam(0x24, 0xFF);    // 空平面没有数据可 DMA, 直接填白
+        return 0;
+    }
+    SetRamWindow(0, 0, EPD_ROW_BYTES, EPD_HEIGHT);     // WriteWindow() 之后窗口和地址计数器都不在整屏原点
+    SendCommand(0x24);
+    DcPin::High();
+    SpiWriteBlockAsync(blackimage, PLANE_BYTES, NULL);
+    return 0;
+}
+
+/**
+ *  @brief: advance DisplayFrameAsync(). Returns true once the refresh has
+ *          finished (BUSY released) or when no frame is in progress.
+ */
+bool Epd::DisplayFrameDone(void) {
+    if (SpiAsyncPoll()) {
+        return false;
+    }
+    switch (async_stage) {
+    case ASYNC_BLACK:
+        async_stage = ASYNC_RED;
+        if (async_red == NULL) {
+            FillRam(0x26, 0x00);
+            return false;
+        }
+        SetRamWindow(0, 0, EPD_ROW_BYTES, EPD_HEIGHT);
+        SendCommand(0x26);
+        DcPin::High();
+        SpiWriteBlockAsync(async_red, PLANE_BYTES, NULL);
+        return false;
+    case ASYNC_RED:
+        SendCommand(0x22);
+        SendData(0xF7);
+        SetBusyMode(EPD_BUSY_TRICOLOR);
+        BusyArm();
+        SendCommand(0x20);
+        async_stage = ASYNC_REFRESH;
+        return false;
+    case ASYNC_REFRESH:
+        if (!BusyDone()) {
+            return false;
         }
+        async_stage = ASYNC_IDLE;
+        return true;
+    default:
+        return true;
     }
+}
 
-    // 3. 执行刷新 (对应佳显驱动的 Update)
-    // 必须先配置 Display Update Control 2 (0x22)
-    SendCommand(0x22);
-    SendData(0xF7);     // 0xF7: 标准全屏刷新 (0xC7 为快刷，但三色屏通常只能全刷)
-    
-    // 激活刷新 (Master Activation)
-    SendCommand(0x20);
-    WaitUntilIdle();
+/**
+ *  @brief: 开始向一个 RAM 平面流式写入一帧 (从第 0 行开始)。之后用
+ *          WriteRows() 按任意高度的行带发送，最后调用 EndFrame()，
+ *          这样不需要整帧缓冲。两个平面依次各写一遍:
+ *          BeginFrame(黑白) ... EndFrame(EPD_REFRESH_NONE)，
+ *          BeginFrame(红) ... EndFrame(EPD_REFRESH_FULL)。
+ *  @param: plane: EPD_PLANE_BW 或 EPD_PLANE_RED
+ *  @return: 0; 平面无效或 DisplayFrameAsync() 未完成时返回 -1
+ */
+int Epd::BeginFrame(unsigned char plane) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
+    }
+    return BeginRows(plane);
+}
+
+/**
+ *  @brief: 结束流式写入的平面。未发送的行保留原 RAM 内容。
+ *  @param: refresh: EPD_REFRESH_FULL 三色全刷，EPD_REFRESH_NONE 只结束
+ *          本平面 (接着写另一个平面)
+ *  @return: 0; 没有正在写入的帧或刷新模式不支持时返回 -1
+ */
+int Epd::EndFrame(int refresh) {
+    if (EndRows() != 0) {
+        return -1;
+    }
+    if (refresh == EPD_REFRESH_FULL) {
+        RefreshTricolor();
+    } else if (refresh != EPD_REFRESH_NONE) {
+        return -1;
+    }
+    return 0;
 }
 
 void Epd::Clear(void) {
     // 1. 发送黑白数据 (Write RAM BW)
     // 填充 0xFF 代表白色 (White)
-    SendCommand(0x24);
-    for (UWORD j = 0; j < height; j++) {
-        for (UWORD i = 0; i < width; i++) {
-            SendData(0xff);
-        }
-    }
+    FillRam(0x24, 0xff);
 
     // 2. 发送红色数据 (Write RAM Red)
     // 【关键修改】这里必须填 0x00 代表无色/透明。
     // 佳显驱动逻辑: 0x00=无色, 0xFF=红色 (与微雪旧版相反)
-    SendCommand(0x26);
-    for (UWORD j = 0; j < height; j++) {
-        for (UWORD i = 0; i < width; i++) {
-            SendData(0x00); // 填 0x00，千万别填 0xff
-        }
-    }
+    FillRam(0x26, 0x00); // 填 0x00，千万别填 0xff
     
-    // 3. 执行刷新 (Update)
-    SendCommand(0x22);
-    SendData(0xF7);     // 使用全屏刷新模式
-    SendCommand(0x20);  // 激活刷新
-    WaitUntilIdle();
+    // 3. 执行刷新 (Update)，使用全屏刷新模式
+    RefreshTricolor();
+}
+
+/**
+ *  @brief: 红色内容只占一小块 (徽标、标题) 时的整帧刷新: 0x26 用片上
+ *          填充清成空白，只上传红色范围的窗口；黑白平面同 DisplayFrame()。
+ *  @param: ryimage: 整帧红色缓冲，red_box 以外必须是空白 (0x00)，
+ *          red_box 通常来自 Paint::GetBounds()
+ *          red_box: 红色内容的范围 (x, w 向外取整到 8 的倍数)，
+ *          w 或 h 为 0 表示没有红色
+ *  @return: 0, 异步帧未完成时返回 -1
+ */
+int Epd::DisplayFrameRedBox(const UBYTE *blackimage, const UBYTE *ryimage, const EpdRect& red_box, int black_hint) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
+    }
+    WritePlane(0x24, blackimage, black_hint);
+    if (plane_state[1] != EPD_RAM_BLANK) {
+        FillRam(0x26, 0x00);
+    }
+    if (ryimage != NULL) {
+        WriteFrameRect(0x26, ryimage, red_box);
+    }
+    RefreshTricolor();
+    return 0;
+}
+
+/**
+ *  @brief: 同 DisplayFrameRedBox()，但红色缓冲只覆盖 red_box，
+ *          不需要整帧的红色缓冲 (2.9" 上整帧红色缓冲是 4736 字节)
+ *  @param: red_window: red_box 的图像，每行 (red_box.w + 7) / 8 字节
+ *          red_box: 窗口在屏上的位置，x 应为 8 的倍数
+ *  @return: 0, 异步帧未完成时返回 -1
+ */
+int Epd::DisplayFrameRedWindow(const UBYTE *blackimage, const UBYTE *red_window, const EpdRect& red_box, int black_hint) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
+    }
+    int stride = (red_box.w + 7) / 8;
+    WritePlane(0x24, blackimage, black_hint);
+    if (plane_state[1] != EPD_RAM_BLANK) {
+        FillRam(0x26, 0x00);
+    }
+    WriteWindow(0x26, red_window, stride, red_box.x >> 3, red_box.y, stride, red_box.h);
+    RefreshTricolor();
+    return 0;
+}
+
+/**
+ *  @brief: 只刷新黑白内容的快速局刷。只把窗口内的黑白数据写入 0x24，
+ *          红色平面 0x26 不动，用上传的黑白局刷波形 (lut_bw_partial)
+ *          代替 15 s 的三色全刷。红色内容只有 DisplayFrame()/Clear()
+ *          全刷时才会改变；局刷多次后应全刷一次消除残影。
+ *  @param: blackimage: 整帧黑白缓冲，每行 EPD_ROW_BYTES 字节
+ *          x, w: 窗口左边和宽度 (像素)，向外取整到 8 的倍数
+ *          y, h: 窗口上边和行数
+ */
+void Epd::DisplayPartBlack(const UBYTE *blackimage, int x, int y, int w, int h) {
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (x + w > EPD_WIDTH) {
+        w = EPD_WIDTH - x;
+    }
+    if (y + h > EPD_HEIGHT) {
+        h = EPD_HEIGHT - y;
+    }
+    if (blackimage == NULL || w <= 0 || h <= 0 || async_stage != ASYNC_IDLE) {
+        return;
+    }
+
+    int xb = x >> 3;
+    int wb = ((x + w - 1) >> 3) - xb + 1;
+    WriteWindow(0x24, blackimage + y * EPD_ROW_BYTES + xb, EPD_ROW_BYTES, xb, y, wb, h);
+
+    // 电压从本屏 OTP 装载，只上传黑白波形 (0x32)；下一次全刷前 RefreshTricolor()
+    // 再从 OTP 装载回三色波形
+    if (!lut_uploaded) {
+        SetBusyMode(EPD_BUSY_OTHER);
+        RunSequence(seq_load_otp, EPD_BUSY_TIMEOUT_MS);
+        SendCommandData(0x32, lut_bw_partial, 153);
+        lut_uploaded = true;
+    }
+
+    SetBusyMode(EPD_BUSY_PART);
+    RunSequence(seq_refresh_bw_part, EPD_BUSY_TIMEOUT_MS);
+}
+
+/**
+ *  @brief: 设置 RAM 窗口为帧的 xb..xb+wb-1 字节列、y..y+h-1 行，地址计数器指向窗口左上角
+ *          (Y 递减模式，帧的第 y 行在 RAM Y = EPD_HEIGHT - 1 - y)
+ */
+void Epd::SetRamWindow(int xb, int y, int wb, int h) {
+    int top = EPD_HEIGHT - 1 - y;
+    int last = EPD_HEIGHT - y - h;
+    SendCommand(0x44);
+    SendData(xb);
+    SendData(xb + wb - 1);
+    SendCommand(0x45);
+    SendData(top & 0xFF);
+    SendData(top >> 8);
+    SendData(last & 0xFF);
+    SendData(last >> 8);
+    SendCommand(0x4E);
+    SendData(xb);
+    SendCommand(0x4F);
+    SendData(top & 0xFF);
+    SendData(top >> 8);
 }
 
 /**
- *  @brief: After this command is transmitted, the chip would enter the 
- *          deep-sleep mode to save power. 
- *          The deep sleep mode would return to standby by hardware reset. 
- *          The only one parameter is a check code, the command would be
+ *  @brief: 地址计数器指向帧的第 y 行 (Y 递减模式，第 0 行在 RAM Y = EPD_HEIGHT - 1)
+ */
+void Epd::SetCursorRow(int y) {
+    SendCommand(0x4E);
+    SendData(0x00);
+    SendCommand(0x4F);
+    SendData((EPD_HEIGHT - 1 - y) & 0xFF);
+    SendData((EPD_HEIGHT - 1 - y) >> 8);
+}
+
+/**
+ *  @brief: Enter SSD1680 deep sleep mode 1 (0x10 0x01) to save power.
+ *          The deep sleep mode would return to standby by hardware reset.
  *          You can use EPD_Reset() to awaken
  */
 void Epd::Sleep(void) {
-    SendCommand(0x02); // POWER_OFF
-    WaitUntilIdle();
-    SendCommand(0x07); // DEEP_SLEEP
-    SendData(0xA5); // check code
+    ForgetPlanes();    // Init() 会软复位，不依赖睡眠后的 RAM 内容
+    WaitUntilIdle();   // 等正在进行的刷新结束，睡眠后 BUSY 一直为高
+    SendCommand(0x10); // deep sleep mode (SSD1680 没有 0x02/0x07 断电/睡眠命令)
+    SendData(0x01);    // mode 1: RAM 保留
 }
 
 
@@ -27,35 +27,56 @@
 #ifndef EPD2IN9B_V3_H
 #define EPD2IN9B_V3_H
 
-#include "epdif.h"
+#include "epdram.h"
 
 // Display resolution
 #define EPD_WIDTH       128
 #define EPD_HEIGHT      296
 
+// Fastest SPI write clock the SSD1680 accepts (50 ns SCL write cycle)
+#define EPD_SPI_CLOCK_MAX       20000000
+
+// 三色全刷约 15 s，超过该时间 WaitUntilIdle 返回超时
+#define EPD_BUSY_TIMEOUT_MS     30000
+
+// 每行 RAM 字节数
+#define EPD_ROW_BYTES   (EPD_WIDTH / 8)
+
 #define UWORD  unsigned int
 #define UBYTE  unsigned char
 
-class Epd : EpdIf {
+class Epd : public EpdRam {
 public:
     Epd();
     ~Epd();
     int  Init(void);
-    void WaitUntilIdle(void);
+    int  WaitUntilIdle(void);
     void Reset(void);
-    void DisplayFrame(const UBYTE *blackimage, const UBYTE *ryimage);
-    void SendCommand(unsigned char command);
-    void SendData(unsigned char data);
+    void DisplayFrame(const UBYTE *blackimage, const UBYTE *ryimage,
+                      int black_hint = EPD_HINT_AUTO, int red_hint = EPD_HINT_AUTO);
+    int  DisplayFrameAsync(const UBYTE *blackimage, const UBYTE *ryimage);
+    bool DisplayFrameDone(void);
+    int  DisplayFrameRedBox(const UBYTE *blackimage, const UBYTE *ryimage,
+                            const EpdRect& red_box, int black_hint = EPD_HINT_AUTO);
+    int  DisplayFrameRedWindow(const UBYTE *blackimage, const UBYTE *red_window,
+                               const EpdRect& red_box, int black_hint = EPD_HINT_AUTO);
+    void DisplayPartBlack(const UBYTE *blackimage, int x, int y, int w, int h);
+    int  BeginFrame(unsigned char plane);
+    int  EndFrame(int refresh);
     void Sleep(void);
     void Clear(void);
     
 private:
-    unsigned int reset_pin;
-    unsigned int dc_pin;
-    unsigned int cs_pin;
-    unsigned int busy_pin;
+    // Y 递减模式的寻址，供 EpdRam 的 RAM 读写使用
+    void SetCursorRow(int y);
+    void SetRamWindow(int xb, int y, int wb, int h);
+    void RefreshTricolor(void);
+    void RestoreOtpLut(void);
     unsigned long width;
     unsigned long height;
+    int async_stage;
+    const UBYTE *async_red;
+    bool lut_uploaded;      // 0x32 里是 lut_bw_partial，全刷前要从 OTP 装载回来
 };
 
 #endif
@@ -25,18 +25,60 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "epd4in2b_V2.h"
 
+/* 控制器命令表 (格式见 epdseq.h): 命令, 长度 [| 等待 BUSY], 参数 */
+static constexpr unsigned char seq_init[] = {
+    // 软件复位
+    0x12, 0 | EPD_SEQ_WAIT,
+    // 驱动输出控制 (Driver Output Control)
+    0x00, 1, 0x13,
+    0x01, 3, 0x2B, 0x01, 0x01,          // (300-1)%256, (300-1)/256
+    // 数据进入模式: 0x01 = X递增, Y递减 (符合一般绘图习惯)
+    0x11, 1, 0x01,
+    // RAM X 地址窗口: 400/8 - 1 = 49 (0x31)
+    0x44, 2, 0x00, 0x31,
+    // RAM Y 地址窗口: 299 (0x12B) 到 0
+    0x45, 4, 0x2B, 0x01, 0x00, 0x00,
+    // 边框波形 (Border Waveform): 0x05通常为白色边框
+    0x3C, 1, 0x05,
+    // 显示更新控制 (Display Update Control)
+    0x21, 2, 0x00, 0x80,
+    // 内置温度传感器
+    0x18, 1, 0x80,
+    // 初始坐标
+    0x4E, 1, 0x00,
+    0x4F, 2 | EPD_SEQ_WAIT, 0x2B, 0x01,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_init);
+
+// 三色全屏刷新 (0xF7)
+static constexpr unsigned char seq_refresh[] = {
+    0x22, 1, 0xF7,
+    0x20, 0 | EPD_SEQ_WAIT,
+    EPD_SEQ_END
+};
+EPD_SEQ_CHECK(seq_refresh);
+
+#define PLANE_BYTES     (EPD_ROW_BYTES * EPD_HEIGHT)
+static_assert(EPD_ROW_BYTES <= EPD_RAM_MAX_ROW_BYTES && EPD_HEIGHT <= EPD_RAM_MAX_HEIGHT,
+              "panel larger than the epdram.h buffers");
+
+// DisplayFrameAsync() 状态
+#define ASYNC_IDLE      0
+#define ASYNC_BLACK     1
+#define ASYNC_RED       2
+#define ASYNC_REFRESH   3
+
 Epd::~Epd() {
 };
 
-Epd::Epd() {
-    reset_pin = RST_PIN;
-    dc_pin = DC_PIN;
-    cs_pin = CS_PIN;
-    busy_pin = BUSY_PIN;
+Epd::Epd() : EpdRam(EPD_ROW_BYTES, EPD_HEIGHT, EPD_SPI_CLOCK_MAX) {
     width = EPD_WIDTH;
     height = EPD_HEIGHT;
+    async_stage = ASYNC_IDLE;
 };
 
 int Epd::Init(void) {
@@ -47,88 +89,24 @@ int Epd::Init(void) {
     
     // 2. 硬件复位
     Reset();
+    ForgetPlanes();
     WaitUntilIdle();
 
-    // 3. 软件复位
-    SendCommand(0x12); 
-    WaitUntilIdle();
-
-
-    // 4. 驱动输出控制 (Driver Output Control)
-    SendCommand(0x00);
-    SendData(0x13);
-
-    SendCommand(0x01);
-    SendData(0x2B); // (300-1)%256
-    SendData(0x01); // (300-1)/256
-    SendData(0x01);
-
-    // 5. 数据进入模式 (Data Entry Mode)
-    // 0x01: X递增, Y递减 (符合一般绘图习惯)
-    SendCommand(0x11);
-    SendData(0x01);
-
-    // 6. 设置 RAM X 地址窗口
-    SendCommand(0x44); 
-    SendData(0x00);
-    SendData(0x31); // 400/8 - 1 = 49 (0x31)
-    
-    // 7. 设置 RAM Y 地址窗口
-    SendCommand(0x45);
-    SendData(0x2B); // 299 (0x12B)
-    SendData(0x01);
-    SendData(0x00);
-    SendData(0x00); 
-
-    // 8. 边框波形 (Border Waveform)
-    SendCommand(0x3C);
-    SendData(0x05); // 0x05通常为白色边框
-
-    // 9. 显示更新控制 (Display Update Control)
-    SendCommand(0x21);
-    SendData(0x00);
-    SendData(0x80);
-
-    // 10. 内置温度传感器
-    SendCommand(0x18);
-    SendData(0x80);
-
-    // 11. 设置初始坐标
-    SendCommand(0x4E); 
-    SendData(0x00);
-    SendCommand(0x4F); 
-    SendData(0x2B);
-    SendData(0x01);
-    
-    WaitUntilIdle();
+    // 3. 软件复位及寄存器配置，见 seq_init
+    if (RunSequence(seq_init, EPD_BUSY_TIMEOUT_MS) != EPD_OK) {
+        return -1;
+    }
     
     // 【重要】删除了 Lut() 调用，使用屏幕内置 OTP 波形
     return 0;
 }
 
 /**
- *  @brief: basic function for sending commands
+ *  @brief: Wait until BUSY goes LOW (SSD1683: HIGH = busy)
+ *  @return: EPD_OK, or EPD_ERR_TIMEOUT
  */
-void Epd::SendCommand(unsigned char command) {
-    DigitalWrite(dc_pin, LOW);
-    SpiTransfer(command);
-}
-
-/**
- *  @brief: basic function for sending data
- */
-void Epd::SendData(unsigned char data) {
-    DigitalWrite(dc_pin, HIGH);
-    SpiTransfer(data);
-}
-
-/**
- *  @brief: Wait until the busy_pin goes HIGH
- */
-void Epd::WaitUntilIdle(void) {
-    while(DigitalRead(busy_pin) == 1) {      //0: busy, 1: idle
-        DelayMs(100);
-    }      
+int Epd::WaitUntilIdle(void) {
+    return WaitBusyIdle(EPD_BUSY_TIMEOUT_MS);
 }
 
 /**
@@ -137,203 +115,301 @@ void Epd::WaitUntilIdle(void) {
  *          see Epd::Sleep();
  */
 void Epd::Reset(void) {
-    DigitalWrite(reset_pin, HIGH);
+    RstPin::High();
     DelayMs(200);   
-    DigitalWrite(reset_pin, LOW);
+    RstPin::Low();
     DelayMs(2);
-    DigitalWrite(reset_pin, HIGH);
+    RstPin::High();
     DelayMs(200);   
 }
 
 /**
- *  @brief: transmit partial data to the SRAM
+ *  @brief: transmit partial data to the SRAM. Only writes RAM, call
+ *          DisplayFrame() to refresh.
+ *  @param: buffer_black, buffer_red: images of the window itself, w / 8
+ *          bytes per row (NULL leaves that plane unchanged)
+ *          x: should be a multiple of 8, the last 3 bits are ignored
  */
 void Epd::SetPartialWindow(const unsigned char* buffer_black, const unsigned char* buffer_red, int x, int y, int w, int l) {
-    SendCommand(PARTIAL_IN);
-    SendCommand(PARTIAL_WINDOW);
-    SendData(x >> 8);
-    SendData(x & 0xf8);     // x should be the multiple of 8, the last 3 bit will always be ignored
-    SendData(((x & 0xf8) + w  - 1) >> 8);
-    SendData(((x & 0xf8) + w  - 1) | 0x07);
-    SendData(y >> 8);        
-    SendData(y & 0xff);
-    SendData((y + l - 1) >> 8);        
-    SendData((y + l - 1) & 0xff);
-    SendData(0x01);         // Gates scan both inside and outside of the partial window. (default) 
-    DelayMs(2);
-    SendCommand(DATA_START_TRANSMISSION_1);
-    if (buffer_black != NULL) {
-        for(int i = 0; i < w  / 8 * l; i++) {
-            SendData(buffer_black[i]);  
-        }  
-    }
-    DelayMs(2);
-    SendCommand(DATA_START_TRANSMISSION_2);
-    if (buffer_red != NULL) {
-        for(int i = 0; i < w  / 8 * l; i++) {
-            SendData(buffer_red[i]);  
-        }  
-    }
-    DelayMs(2);
-    SendCommand(PARTIAL_OUT);  
+    WriteWindow(0x24, buffer_black, w / 8, x >> 3, y, w / 8, l);
+    WriteWindow(0x26, buffer_red, w / 8, x >> 3, y, w / 8, l);
 }
 
 /**
  *  @brief: transmit partial data to the black part of SRAM
  */
 void Epd::SetPartialWindowBlack(const unsigned char* buffer_black, int x, int y, int w, int l) {
-    SendCommand(PARTIAL_IN);
-    SendCommand(PARTIAL_WINDOW);
-    SendData(x >> 8);
-    SendData(x & 0xf8);     // x should be the multiple of 8, the last 3 bit will always be ignored
-    SendData(((x & 0xf8) + w  - 1) >> 8);
-    SendData(((x & 0xf8) + w  - 1) | 0x07);
-    SendData(y >> 8);        
-    SendData(y & 0xff);
-    SendData((y + l - 1) >> 8);        
-    SendData((y + l - 1) & 0xff);
-    SendData(0x01);         // Gates scan both inside and outside of the partial window. (default) 
-    DelayMs(2);
-    SendCommand(DATA_START_TRANSMISSION_1);
-    if (buffer_black != NULL) {
-        for(int i = 0; i < w  / 8 * l; i++) {
-            SendData(buffer_black[i]);  
-        }  
-    }
-    DelayMs(2);
-    SendCommand(PARTIAL_OUT);  
+    WriteWindow(0x24, buffer_black, w / 8, x >> 3, y, w / 8, l);
 }
 
 /**
  *  @brief: transmit partial data to the red part of SRAM
  */
 void Epd::SetPartialWindowRed(const unsigned char* buffer_red, int x, int y, int w, int l) {
-    SendCommand(PARTIAL_IN);
-    SendCommand(PARTIAL_WINDOW);
-    SendData(x >> 8);
-    SendData(x & 0xf8);     // x should be the multiple of 8, the last 3 bit will always be ignored
-    SendData(((x & 0xf8) + w  - 1) >> 8);
-    SendData(((x & 0xf8) + w  - 1) | 0x07);
-    SendData(y >> 8);        
-    SendData(y & 0xff);
-    SendData((y + l - 1) >> 8);        
-    SendData((y + l - 1) & 0xff);
-    SendData(0x01);         // Gates scan both inside and outside of the partial window. (default) 
-    DelayMs(2);
-    SendCommand(DATA_START_TRANSMISSION_2);
-    if (buffer_red != NULL) {
-        for(int i = 0; i < w  / 8 * l; i++) {
-            SendData(buffer_red[i]);  
-        }  
+    WriteWindow(0x26, buffer_red, w / 8, x >> 3, y, w / 8, l);
+}
+
+/**
+ *  @brief: 红色内容只占一小块 (徽标、标题) 时的整帧刷新: 0x26 用片上
+ *          填充清成空白，只上传红色范围的窗口；黑白平面同 DisplayFrame()。
+ *  @param: frame_red: 整帧红色缓冲，red_box 以外必须是空白 (0x00)，
+ *          red_box 通常来自 Paint::GetBounds()
+ *          red_box: 红色内容的范围 (x, w 向外取整到 8 的倍数)，
+ *          w 或 h 为 0 表示没有红色
+ *  @return: 0, 异步帧未完成时返回 -1
+ */
+int Epd::DisplayFrameRedBox(const unsigned char* frame_black, const unsigned char* frame_red, const EpdRect& red_box, int black_hint) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
     }
-    DelayMs(2);
-    SendCommand(PARTIAL_OUT);  
+    WritePlane(0x24, frame_black, black_hint);
+    if (plane_state[1] != EPD_RAM_BLANK) {
+        FillRam(0x26, 0x00);
+    }
+    if (frame_red != NULL) {
+        WriteFrameRect(0x26, frame_red, red_box);
+    }
+    DisplayFrame();
+    return 0;
+}
+
+/**
+ *  @brief: 同 DisplayFrameRedBox()，但红色缓冲只覆盖 red_box，
+ *          不需要整帧的红色缓冲 (4.2" 上省下大部分 15000 字节)
+ *  @param: red_window: red_box 的图像，每行 (red_box.w + 7) / 8 字节
+ *          red_box: 窗口在屏上的位置，x 应为 8 的倍数
+ *  @return: 0, 异步帧未完成时返回 -1
+ */
+int Epd::DisplayFrameRedWindow(const unsigned char* frame_black, const unsigned char* red_window, const EpdRect& red_box, int black_hint) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
+    }
+    int stride = (red_box.w + 7) / 8;
+    WritePlane(0x24, frame_black, black_hint);
+    if (plane_state[1] != EPD_RAM_BLANK) {
+        FillRam(0x26, 0x00);
+    }
+    WriteWindow(0x26, red_window, stride, red_box.x >> 3, red_box.y, stride, red_box.h);
+    DisplayFrame();
+    return 0;
+}
+
+/**
+ *  @brief: 只上传整帧缓冲中变化的矩形，再做一次三色刷新。
+ *          每个平面有自己的矩形列表 (如 EpdDiff::Bands() 的结果)，
+ *          RAM 中矩形以外的内容保持上一帧，所以 400x300 的屏改一小块
+ *          只需发送这几块的数据，而不是两个平面共 30 KB。
+ *          SSD1683 的三色 OTP 波形没有局刷，刷新本身仍是整屏 0xF7。
+ *  @param: frame_black, frame_red: 整帧缓冲，每行 EPD_ROW_BYTES 字节
+ *          black_rects, red_rects: 各平面的变化区域 (x, w 向外取整到 8 的倍数)
+ *          black_count, red_count: 矩形个数，0 表示该平面不变
+ *  @return: 0, 异步帧未完成时返回 -1
+ */
+int Epd::DisplayWindows(const unsigned char* frame_black, const EpdRect* black_rects, int black_count,
+                        const unsigned char* frame_red, const EpdRect* red_rects, int red_count) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
+    }
+    for (int i = 0; i < black_count && frame_black != NULL; i++) {
+        WriteFrameRect(0x24, frame_black, black_rects[i]);
+    }
+    for (int i = 0; i < red_count && frame_red != NULL; i++) {
+        WriteFrameRect(0x26, frame_red, red_rects[i]);
+    }
+    DisplayFrame();
+    return 0;
 }
 
 /**
  * @brief: refresh and displays the frame
  * Adapted for SSD1683 (HINK-E42A48-A1)
+ * @param: black_hint, red_hint: EPD_HINT_* per plane. The default
+ *         EPD_HINT_AUTO scans the plane and fills a blank one on chip;
+ *         EPD_HINT_HASH also skips a plane equal to the last one written.
  */
-void Epd::DisplayFrame(const unsigned char* frame_black, const unsigned char* frame_red) {
-    // --- 关键修正：写黑白数据前，先重置光标到起点 ---
-    SendCommand(0x4E); // Set RAM X Address Counter
-    SendData(0x00);
-    SendCommand(0x4F); // Set RAM Y Address Counter
-    SendData(0x2B);    // Y = 299 (0x12B) 低位
-    SendData(0x01);    // Y = 299 (0x12B) 高位
-    
-    // 1. 写黑白数据 (Write RAM BW)
-    if (frame_black != NULL) {
-        SendCommand(0x24);
-        for (int i = 0; i < 15000; i++) {
-            SendData(pgm_read_byte(&frame_black[i]));
-        }
-    } else {
-        // 如果传入NULL，也建议填白，防止花屏
-        SendCommand(0x24);
-        for (int i = 0; i < 15000; i++) SendData(0xFF);
+void Epd::DisplayFrame(const unsigned char* frame_black, const unsigned char* frame_red, int black_hint, int red_hint) {
+    // 1. 写黑白数据 (Write RAM BW)，每个平面写之前 WritePlane 都把光标重置到起点
+    // 如果传入NULL，填白，防止花屏
+    WritePlane(0x24, frame_black, black_hint);
+
+    // 2. 写红色数据 (Write RAM Red)，传入NULL时填无色(0x00)
+    // 大多数画面红色很少或没有：空白时片上填充
+    WritePlane(0x26, frame_red, red_hint);
+
+    // 3. 刷新
+    SetBusyMode(EPD_BUSY_TRICOLOR);
+    RunSequence(seq_refresh, EPD_BUSY_TIMEOUT_MS);
+}
+
+/**
+ * @brief: non-blocking DisplayFrame. Starts the black plane upload through
+ *         EasyDMA and returns; call DisplayFrameDone() from loop() until it
+ *         returns true. Returns -1 if a previous frame is still in progress.
+ *         Both buffers must stay untouched until the frame is done.
+ */
+int Epd::DisplayFrameAsync(const unsigned char* frame_black, const unsigned char* frame_red) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
     }
+    async_red = frame_red;
+    async_stage = ASYNC_BLACK;
+    ForgetPlanes();
 
-    // --- 写红色数据前，再次重置光标到起点 ---
-    SendCommand(0x4E); 
-    SendData(0x00);
-    SendCommand(0x4F); 
-    SendData(0x2B); 
-    SendData(0x01);
+    if (frame_black == NULL) {
+        FillRam(0x24, 0xFF);
+        return 0;
+    }
+    SetRamWindow(0, 0, EPD_ROW_BYTES, EPD_HEIGHT);     // WriteWindow() 之后窗口和地址计数器都不在整屏原点
+    SendCommand(0x24);
+    DcPin::High();
+    SpiWriteBlockAsync(frame_black, PLANE_BYTES, NULL);
+    return 0;
+}
 
-    // 2. 写红色数据 (Write RAM Red)
-    if (frame_red != NULL) {
-        SendCommand(0x26);
-        for (int i = 0; i < 15000; i++) {
-            SendData(pgm_read_byte(&frame_red[i]));
+/**
+ * @brief: advance DisplayFrameAsync(). Returns true once the refresh has
+ *         finished (BUSY released) or when no frame is in progress.
+ */
+bool Epd::DisplayFrameDone(void) {
+    if (SpiAsyncPoll()) {
+        return false;
+    }
+    switch (async_stage) {
+    case ASYNC_BLACK:
+        async_stage = ASYNC_RED;
+        if (async_red == NULL) {
+            FillRam(0x26, 0x00);
+            return false;
         }
-    } else {
-        // 如果传入NULL，填无色(0x00)
+        SetRamWindow(0, 0, EPD_ROW_BYTES, EPD_HEIGHT);
         SendCommand(0x26);
-        for (int i = 0; i < 15000; i++) SendData(0x00);
+        DcPin::High();
+        SpiWriteBlockAsync(async_red, PLANE_BYTES, NULL);
+        return false;
+    case ASYNC_RED:
+        SendCommand(0x22);
+        SendData(0xF7);
+        SetBusyMode(EPD_BUSY_TRICOLOR);
+        BusyArm();
+        SendCommand(0x20);
+        async_stage = ASYNC_REFRESH;
+        return false;
+    case ASYNC_REFRESH:
+        if (!BusyDone()) {
+            return false;
+        }
+        async_stage = ASYNC_IDLE;
+        return true;
+    default:
+        return true;
     }
+}
 
-    // 3. 刷新
-    SendCommand(0x22); 
-    SendData(0xF7);    
-    SendCommand(0x20); 
-    WaitUntilIdle();
+/**
+ *  @brief: 开始向一个 RAM 平面流式写入一帧 (从第 0 行开始)。之后用
+ *          WriteRows() 按任意高度的行带发送，最后调用 EndFrame()，
+ *          这样不需要整帧缓冲。两个平面依次各写一遍:
+ *          BeginFrame(黑白) ... EndFrame(EPD_REFRESH_NONE)，
+ *          BeginFrame(红) ... EndFrame(EPD_REFRESH_FULL)。
+ *  @param: plane: EPD_PLANE_BW 或 EPD_PLANE_RED
+ *  @return: 0; 平面无效或 DisplayFrameAsync() 未完成时返回 -1
+ */
+int Epd::BeginFrame(unsigned char plane) {
+    if (async_stage != ASYNC_IDLE) {
+        return -1;
+    }
+    return BeginRows(plane);
+}
+
+/**
+ *  @brief: 结束流式写入的平面。未发送的行保留原 RAM 内容。
+ *  @param: refresh: EPD_REFRESH_FULL 三色全刷，EPD_REFRESH_NONE 只结束
+ *          本平面 (接着写另一个平面)
+ *  @return: 0; 没有正在写入的帧或刷新模式不支持时返回 -1
+ */
+int Epd::EndFrame(int refresh) {
+    if (EndRows() != 0) {
+        return -1;
+    }
+    if (refresh == EPD_REFRESH_FULL) {
+        SetBusyMode(EPD_BUSY_TRICOLOR);
+        RunSequence(seq_refresh, EPD_BUSY_TIMEOUT_MS);
+    } else if (refresh != EPD_REFRESH_NONE) {
+        return -1;
+    }
+    return 0;
 }
 
 /**
  * @brief: clear the frame data from the SRAM, this won't refresh the display
  */
 void Epd::ClearFrame(void) {
-    // --- 重置光标 ---
-    SendCommand(0x4E); SendData(0x00);
-    SendCommand(0x4F); SendData(0x2B); SendData(0x01);
-
     // 1. 填黑白显存（全白）
-    SendCommand(0x24);           
-    for(int i = 0; i < 15000; i++) {
-        SendData(0xFF);  
-    }  
-
-    // --- 重置光标 ---
-    SendCommand(0x4E); SendData(0x00);
-    SendCommand(0x4F); SendData(0x2B); SendData(0x01);
+    FillRam(0x24, 0xFF);
 
     // 2. 填红色显存（全透明）
     // 注意：SSD1683 红色通道 0x00 是不显示，如果变红请改回 0xFF
-    SendCommand(0x26);           
-    for(int i = 0; i < 15000; i++) {
-        SendData(0x00);  
-    }  
+    FillRam(0x26, 0x00);
 
     // 3. 刷新
-    SendCommand(0x22); 
-    SendData(0xF7);
-    SendCommand(0x20); 
-    WaitUntilIdle();
+    SetBusyMode(EPD_BUSY_TRICOLOR);
+    RunSequence(seq_refresh, EPD_BUSY_TIMEOUT_MS);
 }
 
 /**
  * @brief: This displays the frame data from SRAM
  */
 void Epd::DisplayFrame(void) {
-    SendCommand(DISPLAY_REFRESH); 
-    DelayMs(100);
-    WaitUntilIdle();
+    // SSD1683 没有 UC8176 的 0x12 (DISPLAY_REFRESH)，0x12 在这里是软件复位
+    SetBusyMode(EPD_BUSY_TRICOLOR);
+    RunSequence(seq_refresh, EPD_BUSY_TIMEOUT_MS);
 }
 
 /**
- * @brief: After this command is transmitted, the chip would enter the deep-sleep mode to save power. 
- *         The deep sleep mode would return to standby by hardware reset. The only one parameter is a 
- *         check code, the command would be executed if check code = 0xA5. 
+ *  @brief: 设置 RAM 窗口为帧的 xb..xb+wb-1 字节列、y..y+h-1 行，地址计数器指向窗口左上角
+ *          (Y 递减模式，帧的第 y 行在 RAM Y = EPD_HEIGHT - 1 - y)
+ */
+void Epd::SetRamWindow(int xb, int y, int wb, int h) {
+    int top = EPD_HEIGHT - 1 - y;
+    int last = EPD_HEIGHT - y - h;
+    SendCommand(0x44);
+    SendData(xb);
+    SendData(xb + wb - 1);
+    SendCommand(0x45);
+    SendData(top & 0xFF);
+    SendData(top >> 8);
+    SendData(last & 0xFF);
+    SendData(last >> 8);
+    SendCommand(0x4E);
+    SendData(xb);
+    SendCommand(0x4F);
+    SendData(top & 0xFF);
+    SendData(top >> 8);
+}
+
+/**
+ *  @brief: 地址计数器指向帧的第 y 行 (Y 递减模式，第 0 行在 RAM Y = EPD_HEIGHT - 1)
+ */
+void Epd::SetCursorRow(int y) {
+    SendCommand(0x4E);
+    SendData(0x00);
+    SendCommand(0x4F);
+    SendData((EPD_HEIGHT - 1 - y) & 0xFF);
+    SendData((EPD_HEIGHT - 1 - y) >> 8);
+}
+
+/**
+ * @brief: Enter SSD1683 deep sleep mode 1 (0x10 0x01) to save power. The
+ *         deep sleep mode would return to standby by hardware reset.
+ *         (The UC8176 commands above, 0x02 power off / 0x07 deep sleep,
+ *         are not implemented by the SSD1683.)
  *         You can use Epd::Reset() to awaken and use Epd::Init() to initialize.
  */
 void Epd::Sleep() {
-    SendCommand(VCOM_AND_DATA_INTERVAL_SETTING);
-    SendData(0xF7);     // border floating
-    SendCommand(POWER_OFF);
-    WaitUntilIdle();
-    SendCommand(DEEP_SLEEP);
-    SendData(0xA5);     // check code
+    ForgetPlanes();    // Init() 会软复位，不依赖睡眠后的 RAM 内容
+    WaitUntilIdle();   // 等正在进行的刷新结束，睡眠后 BUSY 一直为高
+    SendCommand(0x10); // deep sleep mode
+    SendData(0x01);    // mode 1: RAM 保留
 }
 
 
@@ -27,12 +27,21 @@
 #ifndef EPD4IN2_V2_H
 #define EPD4IN2_V2_H
 
-#include "epdif.h"
+#include "epdram.h"
 
 // Display resolution
 #define EPD_WIDTH       400
 #define EPD_HEIGHT      300
 
+// Fastest SPI write clock the SSD1683 accepts (50 ns SCL write cycle)
+#define EPD_SPI_CLOCK_MAX       20000000
+
+// Longest BUSY period (tri-color full refresh) before WaitUntilIdle gives up
+#define EPD_BUSY_TIMEOUT_MS     30000
+
+// Bytes per RAM row
+#define EPD_ROW_BYTES   (EPD_WIDTH / 8)
+
 // EPD4IN2 commands
 #define PANEL_SETTING                               0x00
 #define POWER_SETTING                               0x01
@@ -73,7 +82,7 @@
 #define READ_OTP                                    0xA2
 #define POWER_SAVING                                0xE3
 
-class Epd : EpdIf {
+class Epd : public EpdRam {
 public:
     unsigned int width;
     unsigned int height;
@@ -81,23 +90,33 @@ public:
     Epd();
     ~Epd();
     int  Init(void);
-    void SendCommand(unsigned char command);
-    void SendData(unsigned char data);
-    void WaitUntilIdle(void);
+    int  WaitUntilIdle(void);
     void Reset(void);
     void SetPartialWindow(const unsigned char* buffer_black, const unsigned char* buffer_red, int x, int y, int w, int l);
     void SetPartialWindowBlack(const unsigned char* buffer_black, int x, int y, int w, int l);
     void SetPartialWindowRed(const unsigned char* buffer_red, int x, int y, int w, int l);
-    void DisplayFrame(const unsigned char* frame_black, const unsigned char* frame_red);
+    void DisplayFrame(const unsigned char* frame_black, const unsigned char* frame_red,
+                      int black_hint = EPD_HINT_AUTO, int red_hint = EPD_HINT_AUTO);
     void DisplayFrame(void);
+    int  DisplayFrameRedBox(const unsigned char* frame_black, const unsigned char* frame_red,
+                            const EpdRect& red_box, int black_hint = EPD_HINT_AUTO);
+    int  DisplayFrameRedWindow(const unsigned char* frame_black, const unsigned char* red_window,
+                               const EpdRect& red_box, int black_hint = EPD_HINT_AUTO);
+    int  DisplayWindows(const unsigned char* frame_black, const EpdRect* black_rects, int black_count,
+                        const unsigned char* frame_red, const EpdRect* red_rects, int red_count);
+    int  DisplayFrameAsync(const unsigned char* frame_black, const unsigned char* frame_red);
+    bool DisplayFrameDone(void);
+    int  BeginFrame(unsigned char plane);
+    int  EndFrame(int refresh);
     void ClearFrame(void);
     void Sleep(void);
 
 private:
-    unsigned int reset_pin;
-    unsigned int dc_pin;
-    unsigned int cs_pin;
-    unsigned int busy_pin;
+    // Y-decrement addressing for the EpdRam RAM access
+    void SetCursorRow(int y);
+    void SetRamWindow(int xb, int y, int wb, int h);
+    int async_stage;
+    const unsigned char* async_red;
 };
 
 #endif /* EPD4IN2_H */
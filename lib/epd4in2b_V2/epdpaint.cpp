@@ -33,13 +33,16 @@ Paint::Paint(unsigned char* image, int width, int height) {
     /* 1 byte = 8 pixels, so the width should be the multiple of 8 */
     this->width = width % 8 ? width + 8 - (width % 8) : width;
     this->height = height;
+    ResetBounds();
 }
 
 Paint::~Paint() {
 }
 
 /**
- *  @brief: clear the image
+ *  @brief: clear the image. Clearing to the uncolored value empties the
+ *          bounds; clearing to colored leaves the whole image inside them,
+ *          since every pixel now differs from a blank plane.
  */
 void Paint::Clear(int colored) {
     for (int x = 0; x < this->width; x++) {
@@ -47,6 +50,9 @@ void Paint::Clear(int colored) {
             DrawAbsolutePixel(x, y, colored);
         }
     }
+    if (!colored) {
+        ResetBounds();
+    }
 }
 
 /**
@@ -57,6 +63,18 @@ void Paint::DrawAbsolutePixel(int x, int y, int colored) {
     if (x < 0 || x >= this->width || y < 0 || y >= this->height) {
         return;
     }
+    if (x < bound_x0) {
+        bound_x0 = x;
+    }
+    if (x > bound_x1) {
+        bound_x1 = x;
+    }
+    if (y < bound_y0) {
+        bound_y0 = y;
+    }
+    if (y > bound_y1) {
+        bound_y1 = y;
+    }
     if (IF_INVERT_COLOR) {
         if (colored) {
             image[(x + y * this->width) / 8] |= 0x80 >> (x % 8);
@@ -72,6 +90,34 @@ void Paint::DrawAbsolutePixel(int x, int y, int colored) {
     }
 }
 
+/**
+ *  @brief: bounding box of everything drawn since the last Clear() or
+ *          ResetBounds(), in image coordinates (rotation already applied).
+ *          Outside it the image still holds the Clear() color, so a
+ *          tri-color driver only has to upload this window of the red
+ *          plane (Epd::DisplayFrameRedBox).
+ *  @return: false, with an empty box, if nothing was drawn
+ */
+bool Paint::GetBounds(EpdRect* box) {
+    if (bound_x1 < bound_x0) {
+        box->x = box->y = box->w = box->h = 0;
+        return false;
+    }
+    box->x = bound_x0;
+    box->y = bound_y0;
+    box->w = bound_x1 - bound_x0 + 1;
+    box->h = bound_y1 - bound_y0 + 1;
+    return true;
+}
+
+/**
+ *  @brief: start a new bounding box without clearing the image
+ */
+void Paint::ResetBounds(void) {
+    bound_x0 = bound_y0 = 0x7FFF;
+    bound_x1 = bound_y1 = -1;
+}
+
 /**
  *  @brief: Getters and Setters
  */
@@ -37,6 +37,7 @@
 #define IF_INVERT_COLOR     1
 
 #include "fonts.h"
+#include "epddiff.h"
 
 class Paint {
 public:
@@ -64,11 +65,20 @@ public:
 
     void DrawImage(int x, int y, int width, int height, const unsigned char* image_data, int colored);
 
+    bool GetBounds(EpdRect* box);
+    void ResetBounds(void);
+
 private:
     unsigned char* image;
     int width;
     int height;
     int rotate;
+    /* pixels drawn since an uncolored Clear() or ResetBounds(), in image
+     * coordinates; empty while bound_x1 < bound_x0 */
+    int bound_x0;
+    int bound_y0;
+    int bound_x1;
+    int bound_y1;
 };
 
 #endif
@@ -0,0 +1,97 @@
+/**
+ *  @filename   :   epdarbiter.cpp
+ *  @brief      :   Shared-bus panel scheduler, see epdarbiter.h
+ */
+
+#include "epdarbiter.h"
+
+/* Sleep bound in RunUntilIdle() while every running job waits for BUSY;
+ * a BUSY falling edge ends it early */
+#define ARB_IDLE_WAIT_MS    100
+
+EpdArbiter::EpdArbiter(void) {
+    for (int i = 0; i < EPD_MAX_PANELS; i++) {
+        head[i] = 0;
+        count[i] = 0;
+        running[i] = false;
+    }
+    owner = -1;
+    next = 0;
+}
+
+/**
+ *  @brief: queue a job for a panel. Returns 0, or -1 if the panel's queue
+ *          is full.
+ */
+int EpdArbiter::Submit(int panel, EpdJobStart start, EpdJobPoll poll, void* ctx) {
+    if (panel < 0 || panel >= EPD_MAX_PANELS || count[panel] >= EPD_ARB_QUEUE) {
+        return -1;
+    }
+    Job& job = queue[panel][(head[panel] + count[panel]) % EPD_ARB_QUEUE];
+    job.start = start;
+    job.poll = poll;
+    job.ctx = ctx;
+    count[panel]++;
+    return 0;
+}
+
+/**
+ *  @brief: one scheduling pass over all panels, round robin. Polls running
+ *          jobs and starts the next queued job of every panel whenever the
+ *          bus is free. Returns true while any job is queued or running.
+ */
+bool EpdArbiter::Run(void) {
+    for (int i = 0; i < EPD_MAX_PANELS; i++) {
+        int panel = (next + i) % EPD_MAX_PANELS;
+        if (count[panel] == 0) {
+            continue;
+        }
+        if (owner >= 0 && owner != panel) {
+            continue;                       // EasyDMA to another panel
+        }
+        if (EpdIf::SelectPanel(panel) != 0) {
+            continue;
+        }
+        Job& job = queue[panel][head[panel]];
+        if (!running[panel]) {
+            job.start(job.ctx);
+            running[panel] = true;
+        }
+        if (job.poll == NULL || job.poll(job.ctx)) {
+            running[panel] = false;
+            head[panel] = (head[panel] + 1) % EPD_ARB_QUEUE;
+            count[panel]--;
+        }
+        owner = EpdIf::SpiBusy() ? panel : -1;
+    }
+    next = (next + 1) % EPD_MAX_PANELS;
+    return !Idle();
+}
+
+/**
+ *  @brief: run until every queue is empty. While no transfer is in flight
+ *          the task sleeps on the BUSY edge interrupt between passes,
+ *          otherwise it yields while EasyDMA streams.
+ */
+void EpdArbiter::RunUntilIdle(void) {
+    while (Run()) {
+        if (owner < 0) {
+            EpdIf::WaitBusyEvent(ARB_IDLE_WAIT_MS);
+        } else {
+            yield();
+        }
+    }
+}
+
+bool EpdArbiter::Idle(void) {
+    for (int i = 0; i < EPD_MAX_PANELS; i++) {
+        if (count[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int EpdArbiter::Pending(int panel) {
+    return count[panel];
+}
@@ -0,0 +1,53 @@
+/**
+ *  @filename   :   epdarbiter.h
+ *  @brief      :   Schedules work for several panels on the shared SPI bus
+ *                  (see EpdIf::AddPanel()). A panel spends seconds in BUSY
+ *                  after a refresh is triggered and needs no bus meanwhile,
+ *                  so uploads to the other panels are started in that time.
+ *
+ *  A job is a start()/poll() pair. start() runs with its panel selected and
+ *  the bus free; it sends what it needs (possibly via EasyDMA) and returns.
+ *  poll() then runs, with the panel selected again, on every Run() until it
+ *  returns true. The DisplayFrameAsync()/DisplayFrameDone() pair of the
+ *  tri-color drivers fits this directly; a NULL poll() marks a blocking job.
+ *
+ *  While a job has an EasyDMA transfer in flight only that panel is polled;
+ *  as soon as it is waiting for BUSY the next panel gets the bus.
+ */
+
+#ifndef EPDARBITER_H
+#define EPDARBITER_H
+
+#include "epdif.h"
+
+// Jobs that can wait per panel
+#define EPD_ARB_QUEUE       4
+
+typedef void (*EpdJobStart)(void* ctx);
+typedef bool (*EpdJobPoll)(void* ctx);
+
+class EpdArbiter {
+public:
+    EpdArbiter(void);
+
+    int  Submit(int panel, EpdJobStart start, EpdJobPoll poll, void* ctx);
+    bool Run(void);
+    void RunUntilIdle(void);
+    bool Idle(void);
+    int  Pending(int panel);
+
+private:
+    struct Job {
+        EpdJobStart start;
+        EpdJobPoll poll;
+        void* ctx;
+    };
+    Job queue[EPD_MAX_PANELS][EPD_ARB_QUEUE];
+    unsigned char head[EPD_MAX_PANELS];
+    unsigned char count[EPD_MAX_PANELS];
+    bool running[EPD_MAX_PANELS];
+    int owner;
+    int next;
+};
+
+#endif /* EPDARBITER_H */
@@ -0,0 +1,100 @@
+/**
+ *  @filename   :   epdbus.h
+ *  @brief      :   Compile-time pin and SPI binding for the EPD transport.
+ *                  Pins are resolved to NRF_P0/NRF_P1 OUTSET/OUTCLR/IN
+ *                  register accesses at compile time, so driving DC/CS/RST
+ *                  and sampling BUSY costs a single store or load instead of
+ *                  a digitalWrite()/digitalRead() call and pin-map lookup.
+ *
+ *                  Pin numbers are nRF GPIO numbers (NRF_GPIO_PIN_MAP).
+ *                  The Nice!nano variant maps Arduino pins 1:1 onto them, so
+ *                  pinMode() can still be used to configure the same pins.
+ */
+
+#ifndef EPDBUS_H
+#define EPDBUS_H
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#ifdef EPDIF_HOST
+/* Host build (tools/epdtrace): pin activity goes to the trace recorder */
+void EpdHostPinWrite(unsigned long pin, int value);
+int  EpdHostPinRead(unsigned long pin);
+
+template <unsigned long Pin>
+class EpdPin {
+public:
+    static inline void High(void) { EpdHostPinWrite(Pin, HIGH); }
+    static inline void Low(void)  { EpdHostPinWrite(Pin, LOW); }
+    static inline void Write(int value) { EpdHostPinWrite(Pin, value ? HIGH : LOW); }
+    static inline int Read(void) { return EpdHostPinRead(Pin); }
+};
+
+static inline void EpdGpioWrite(unsigned long pin, int value) { EpdHostPinWrite(pin, value ? HIGH : LOW); }
+static inline int  EpdGpioRead(unsigned long pin) { return EpdHostPinRead(pin); }
+#else
+template <unsigned long Pin>
+class EpdPin {
+public:
+    static const unsigned long Mask = 1UL << (Pin & 0x1F);
+
+    static inline NRF_GPIO_Type* Port(void) {
+#ifdef NRF_P1
+        return (Pin >> 5) ? NRF_P1 : NRF_P0;
+#else
+        return NRF_P0;
+#endif
+    }
+    static inline void High(void) { Port()->OUTSET = Mask; }
+    static inline void Low(void)  { Port()->OUTCLR = Mask; }
+    static inline void Write(int value) {
+        if (value) {
+            High();
+        } else {
+            Low();
+        }
+    }
+    static inline int Read(void) { return (Port()->IN & Mask) ? HIGH : LOW; }
+};
+
+/* Same register access for pins only known at run time (per-panel CS and
+ * BUSY lines, see EpdIf::AddPanel()) */
+static inline NRF_GPIO_Type* EpdGpioPort(unsigned long pin) {
+#ifdef NRF_P1
+    return (pin >> 5) ? NRF_P1 : NRF_P0;
+#else
+    return NRF_P0;
+#endif
+}
+
+static inline void EpdGpioWrite(unsigned long pin, int value) {
+    if (value) {
+        EpdGpioPort(pin)->OUTSET = 1UL << (pin & 0x1F);
+    } else {
+        EpdGpioPort(pin)->OUTCLR = 1UL << (pin & 0x1F);
+    }
+}
+
+static inline int EpdGpioRead(unsigned long pin) {
+    return (EpdGpioPort(pin)->IN & (1UL << (pin & 0x1F))) ? HIGH : LOW;
+}
+#endif
+
+template <unsigned long Rst, unsigned long Dc, unsigned long Cs, unsigned long Busy, SPIClass& SpiPort>
+class EpdBus {
+public:
+    typedef EpdPin<Rst>  RstPin;
+    typedef EpdPin<Dc>   DcPin;
+    typedef EpdPin<Cs>   CsPin;
+    typedef EpdPin<Busy> BusyPin;
+
+    static const unsigned long RST  = Rst;
+    static const unsigned long DC   = Dc;
+    static const unsigned long CS   = Cs;
+    static const unsigned long BUSY = Busy;
+
+    static inline SPIClass& Spi(void) { return SpiPort; }
+};
+
+#endif /* EPDBUS_H */
@@ -0,0 +1,60 @@
+/**
+ *  @filename   :   epdbusy.cpp
+ *  @brief      :   BUSY duration model, see epdbusy.h
+ */
+
+#include "epdbusy.h"
+
+void EpdBusyModel::Add(unsigned char mode, unsigned long ms) {
+    if (mode >= EPD_BUSY_MODES) {
+        return;
+    }
+    history[mode][next[mode]] = ms > 0xFFFF ? 0xFFFF : ms;
+    next[mode] = (next[mode] + 1) % EPD_BUSY_HISTORY;
+    if (count[mode] < EPD_BUSY_HISTORY) {
+        count[mode]++;
+    }
+}
+
+/**
+ *  @brief: how long a wait in this mode can sleep without looking at BUSY:
+ *          the shortest recent duration minus a margin, 0 until at least
+ *          two samples agree on it
+ */
+unsigned long EpdBusyModel::SleepHint(unsigned char mode) const {
+    EpdBusyStats stats;
+    Stats(mode, &stats);
+    if (stats.count < 2 || stats.min_ms <= EPD_BUSY_MARGIN_MS) {
+        return 0;
+    }
+    return stats.min_ms - EPD_BUSY_MARGIN_MS;
+}
+
+void EpdBusyModel::Stats(unsigned char mode, EpdBusyStats* stats) const {
+    stats->count = 0;
+    stats->min_ms = 0;
+    stats->mean_ms = 0;
+    stats->p95_ms = 0;
+    if (mode >= EPD_BUSY_MODES || count[mode] == 0) {
+        return;
+    }
+
+    /* insertion sort of at most EPD_BUSY_HISTORY samples */
+    unsigned short sorted[EPD_BUSY_HISTORY];
+    unsigned int n = count[mode];
+    unsigned long sum = 0;
+    for (unsigned int i = 0; i < n; i++) {
+        unsigned short v = history[mode][i];
+        unsigned int j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+        sum += v;
+    }
+    stats->count = n;
+    stats->min_ms = sorted[0];
+    stats->mean_ms = sum / n;
+    stats->p95_ms = sorted[(n * 95 + 99) / 100 - 1];
+}
@@ -0,0 +1,47 @@
+/**
+ *  @filename   :   epdbusy.h
+ *  @brief      :   Running model of BUSY durations per refresh mode.
+ *                  Keeps the last few measured durations of every mode and
+ *                  derives a sleep hint and min/mean/p95 statistics from
+ *                  them. Recent samples only, so the model follows slow
+ *                  drifts such as ambient temperature.
+ */
+
+#ifndef EPDBUSY_H
+#define EPDBUSY_H
+
+// Refresh modes the drivers tag their BUSY waits with (EpdIf::SetBusyMode)
+#define EPD_BUSY_OTHER      0       // reset, power on/off, untagged waits
+#define EPD_BUSY_FULL       1       // B/W full refresh
+#define EPD_BUSY_PART       2       // B/W partial refresh
+#define EPD_BUSY_TRICOLOR   3       // black/red full refresh
+#define EPD_BUSY_FAST       4       // B/W full refresh with the fast waveform
+#define EPD_BUSY_MODES      5
+
+// Samples kept per mode
+#define EPD_BUSY_HISTORY    8
+
+// Sleep this much less than the shortest recent duration before waiting
+// for the BUSY edge, so a slightly faster refresh is not overslept
+#define EPD_BUSY_MARGIN_MS  20
+
+struct EpdBusyStats {
+    unsigned int count;             // samples the figures are based on
+    unsigned long min_ms;
+    unsigned long mean_ms;
+    unsigned long p95_ms;
+};
+
+class EpdBusyModel {
+public:
+    void Add(unsigned char mode, unsigned long ms);
+    unsigned long SleepHint(unsigned char mode) const;
+    void Stats(unsigned char mode, EpdBusyStats* stats) const;
+
+private:
+    unsigned short history[EPD_BUSY_MODES][EPD_BUSY_HISTORY];
+    unsigned char count[EPD_BUSY_MODES];
+    unsigned char next[EPD_BUSY_MODES];
+};
+
+#endif /* EPDBUSY_H */
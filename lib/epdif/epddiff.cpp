@@ -0,0 +1,145 @@
+/**
+ *  @filename   :   epddiff.cpp
+ *  @brief      :   Shadow-frame change detection, see epddiff.h
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "epddiff.h"
+
+EpdDiff::EpdDiff(unsigned char* shadow, int width_bytes, int height) {
+    this->shadow = shadow;
+    this->width_bytes = width_bytes;
+    this->height = height;
+    valid = false;
+}
+
+/**
+ *  @brief: first and last changed byte of row y. Whole words are XORed
+ *          first; bytes are only looked at inside the outermost changed
+ *          words and in the tail that does not fill a word.
+ *  @return: false if the row is unchanged
+ */
+bool EpdDiff::RowSpan(const unsigned char* frame, int y, int* first, int* last) {
+    const unsigned char* a = frame + y * width_bytes;
+    const unsigned char* b = shadow + y * width_bytes;
+    int words = width_bytes / 4;
+    int lo = -1;
+    int hi = -1;
+
+    for (int i = 0; i < words; i++) {
+        uint32_t wa, wb;
+        memcpy(&wa, a + i * 4, 4);  // unaligned-safe, a single LDR on Cortex-M4
+        memcpy(&wb, b + i * 4, 4);
+        if (wa ^ wb) {
+            if (lo < 0) {
+                lo = i * 4;
+            }
+            hi = i * 4 + 3;
+        }
+    }
+    for (int i = words * 4; i < width_bytes; i++) {
+        if (a[i] != b[i]) {
+            if (lo < 0) {
+                lo = i;
+            }
+            hi = i;
+        }
+    }
+    if (lo < 0) {
+        return false;
+    }
+    while (a[lo] == b[lo]) {
+        lo++;
+    }
+    while (a[hi] == b[hi]) {
+        hi--;
+    }
+    *first = lo;
+    *last = hi;
+    return true;
+}
+
+/**
+ *  @brief: tight bounding box of everything that changed since Commit().
+ *          Before the first Commit() (or after Invalidate()) the whole
+ *          frame counts as changed.
+ *  @return: false if nothing changed
+ */
+bool EpdDiff::Compare(const unsigned char* frame, EpdRect* box) {
+    EpdRect bands[1];
+    if (Bands(frame, bands, 1) == 0) {
+        return false;
+    }
+    *box = bands[0];
+    return true;
+}
+
+/**
+ *  @brief: changed areas as up to max_bands row bands, top to bottom, each
+ *          with its own column span. Bands separated by fewer than
+ *          EPD_DIFF_MERGE_ROWS unchanged rows are merged, and so are the
+ *          last ones once max_bands is reached.
+ *  @return: number of bands, 0 if nothing changed
+ */
+int EpdDiff::Bands(const unsigned char* frame, EpdRect* bands, int max_bands) {
+    if (max_bands <= 0) {
+        return 0;
+    }
+    if (!valid) {
+        bands[0].x = 0;
+        bands[0].y = 0;
+        bands[0].w = width_bytes * 8;
+        bands[0].h = height;
+        return 1;
+    }
+
+    int n = 0;
+    int lo = 0, hi = 0, top = 0, bottom = -1;
+    for (int y = 0; y < height; y++) {
+        int first, last;
+        if (!RowSpan(frame, y, &first, &last)) {
+            continue;
+        }
+        if (bottom >= 0 && (y - bottom - 1 < EPD_DIFF_MERGE_ROWS || n == max_bands - 1)) {
+            bottom = y;
+            lo = first < lo ? first : lo;
+            hi = last > hi ? last : hi;
+            continue;
+        }
+        if (bottom >= 0) {
+            bands[n].x = lo * 8;
+            bands[n].y = top;
+            bands[n].w = (hi - lo + 1) * 8;
+            bands[n].h = bottom - top + 1;
+            n++;
+        }
+        top = bottom = y;
+        lo = first;
+        hi = last;
+    }
+    if (bottom >= 0) {
+        bands[n].x = lo * 8;
+        bands[n].y = top;
+        bands[n].w = (hi - lo + 1) * 8;
+        bands[n].h = bottom - top + 1;
+        n++;
+    }
+    return n;
+}
+
+/**
+ *  @brief: record frame as what the panel now shows
+ */
+void EpdDiff::Commit(const unsigned char* frame) {
+    memcpy(shadow, frame, width_bytes * height);
+    valid = true;
+}
+
+/**
+ *  @brief: forget the shadow, e.g. after the panel was cleared or drawn
+ *          to without going through this diff
+ */
+void EpdDiff::Invalidate(void) {
+    valid = false;
+}
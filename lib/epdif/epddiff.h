@@ -0,0 +1,46 @@
+/**
+ *  @filename   :   epddiff.h
+ *  @brief      :   Change detection between the frame last sent to a panel
+ *                  and the next one. Keeps a shadow copy of the sent frame,
+ *                  XORs the new frame against it a 32-bit word at a time and
+ *                  reports the changed area as a bounding box or as a few
+ *                  row bands, ready for a windowed partial update.
+ *
+ *                  The shadow buffer is supplied by the caller (one frame,
+ *                  width_bytes * height) so its placement stays visible.
+ */
+
+#ifndef EPDDIFF_H
+#define EPDDIFF_H
+
+// Bands closer than this many unchanged rows are merged into one, since a
+// second window costs more in commands than rewriting a few rows
+#define EPD_DIFF_MERGE_ROWS     4
+
+// Changed area; x and w in pixels, always whole bytes
+struct EpdRect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+class EpdDiff {
+public:
+    EpdDiff(unsigned char* shadow, int width_bytes, int height);
+
+    bool Compare(const unsigned char* frame, EpdRect* box);
+    int  Bands(const unsigned char* frame, EpdRect* bands, int max_bands);
+    void Commit(const unsigned char* frame);
+    void Invalidate(void);
+
+private:
+    bool RowSpan(const unsigned char* frame, int y, int* first, int* last);
+
+    unsigned char* shadow;
+    int width_bytes;
+    int height;
+    bool valid;
+};
+
+#endif /* EPDDIFF_H */
@@ -0,0 +1,462 @@
+/**
+ *  @filename   :   epdif.cpp
+ *  @brief      :   Implements EPD interface functions
+ *                  shared by all panel drivers in lib/
+ *  @author     :   Yehui from Waveshare
+ *
+ *  Copyright (C) Waveshare     August 10 2017
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documnetation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to  whom the Software is
+ * furished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS OR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "epdif.h"
+#include <SPI.h>
+
+/* SPI.transfer() runs on EasyDMA, which cannot read from flash,
+ * so block payloads are staged through this buffer in chunks */
+#define SPI_STAGE_SIZE  128
+static unsigned char spi_stage[SPI_STAGE_SIZE];
+
+/* SPIM instance behind the Arduino SPI object, and the largest transfer
+ * a single EasyDMA descriptor can carry (width of MAXCNT) */
+#if defined(NRF_SPIM3)
+#define EPD_SPIM            NRF_SPIM3
+#define EPD_SPIM_MAXCNT     0xFFFF
+#else
+#define EPD_SPIM            NRF_SPIM2
+#define EPD_SPIM_MAXCNT     0xFF
+#endif
+
+static const unsigned char* async_data;
+static unsigned int async_len;
+static EpdIfCallback async_done;
+static bool async_active = false;
+
+/* Panels on the shared bus. Every transfer goes to panels[active]; the
+ * clock is kept per panel because calibration may settle on different
+ * rates for different controllers, and so are the learned BUSY times */
+struct EpdPanel {
+    unsigned long cs;
+    unsigned long busy;
+    unsigned long clock;
+    volatile bool busy_edge;
+    unsigned long busy_armed_at;
+    volatile unsigned long busy_fell_at;
+    bool busy_timing;                   // armed, duration not recorded yet
+    unsigned char busy_mode;            // tag of the next BUSY period
+    EpdBusyModel busy_model;
+};
+static EpdPanel panels[EPD_MAX_PANELS] = {
+    { CS_PIN, BUSY_PIN, EPD_SPI_CLOCK_DEFAULT, false, 0 },
+};
+static int panel_count = 1;
+static int active = 0;
+static unsigned long async_cs;
+
+/* BUSY is HIGH while the controller works; its falling edge is latched
+ * by BusyIsr<N>() and wakes the task blocked in WaitBusyIdle() */
+static SemaphoreHandle_t busy_sem = NULL;
+
+/* BUSY has to rise within this long after BusyArm(), otherwise a LOW pin
+ * means the controller never started and BusyDone() reports idle */
+#define BUSY_RISE_MS    50
+
+template <int N>
+static void BusyIsr(void) {
+    BaseType_t woken = pdFALSE;
+    panels[N].busy_edge = true;
+    panels[N].busy_fell_at = millis();
+    xSemaphoreGiveFromISR(busy_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void (*const busy_isr[])(void) = { BusyIsr<0>, BusyIsr<1>, BusyIsr<2>, BusyIsr<3> };
+static_assert(EPD_MAX_PANELS <= sizeof(busy_isr) / sizeof(busy_isr[0]),
+              "add BusyIsr<N> entries for EPD_MAX_PANELS");
+
+static inline void CsLow(void) {
+    EpdGpioWrite(panels[active].cs, LOW);
+}
+
+static inline void CsHigh(void) {
+    EpdGpioWrite(panels[active].cs, HIGH);
+}
+
+static void PanelPinInit(int panel) {
+    pinMode(panels[panel].cs, OUTPUT);
+    EpdGpioWrite(panels[panel].cs, HIGH);
+    pinMode(panels[panel].busy, INPUT);
+    if (busy_sem != NULL) {
+        attachInterrupt(digitalPinToInterrupt(panels[panel].busy), busy_isr[panel], FALLING);
+    }
+}
+
+static bool IsInRam(const void* p) {
+    return ((unsigned long)p & 0xE0000000UL) == 0x20000000UL;
+}
+
+static void DmaStart(const unsigned char* data, unsigned int len) {
+    EPD_SPIM->TXD.PTR = (unsigned long)data;
+    EPD_SPIM->TXD.MAXCNT = len;
+    EPD_SPIM->RXD.MAXCNT = 0;
+    EPD_SPIM->EVENTS_END = 0;
+    EPD_SPIM->TASKS_START = 1;
+}
+
+static bool DmaDone(void) {
+    return EPD_SPIM->EVENTS_END != 0;
+}
+
+static void DmaNextChunk(void) {
+    unsigned int n = async_len > EPD_SPIM_MAXCNT ? EPD_SPIM_MAXCNT : async_len;
+    DmaStart(async_data, n);
+    async_data += n;
+    async_len -= n;
+}
+
+EpdIf::EpdIf() {
+};
+
+EpdIf::~EpdIf() {
+};
+
+void EpdIf::DigitalWrite(int pin, int value) {
+    digitalWrite(pin, value);
+}
+
+int EpdIf::DigitalRead(int pin) {
+    return digitalRead(pin);
+}
+
+void EpdIf::DelayMs(unsigned int delaytime) {
+    delay(delaytime);
+}
+
+void EpdIf::SpiTransfer(unsigned char data) {
+    CsLow();
+    Spi().transfer(data);
+    CsHigh();
+}
+
+/**
+ *  @brief: clock len bytes in from the panel. Needs the panel SDA line
+ *          wired to MISO as well (series resistor on the MOSI side).
+ */
+void EpdIf::SpiReadBlock(unsigned char* data, unsigned int len) {
+    memset(data, 0xFF, len);
+    CsLow();
+    Spi().transfer(data, len);
+    CsHigh();
+}
+
+/**
+ *  @brief: switch the SPI clock of the active panel; it also applies to
+ *          later IfInit() and SelectPanel() calls
+ */
+void EpdIf::SetSpiClock(unsigned long hz) {
+    panels[active].clock = hz;
+    Spi().endTransaction();
+    Spi().beginTransaction(SPISettings(hz, MSBFIRST, SPI_MODE0));
+}
+
+unsigned long EpdIf::GetSpiClock(void) {
+    return panels[active].clock;
+}
+
+/**
+ *  @brief: write a whole payload with CS held low for the entire block
+ */
+void EpdIf::SpiWriteBlock(const unsigned char* data, unsigned int len) {
+    CsLow();
+    while (len > 0) {
+        unsigned int n = len > SPI_STAGE_SIZE ? SPI_STAGE_SIZE : len;
+        memcpy(spi_stage, data, n);
+        Spi().transfer(spi_stage, n);
+        data += n;
+        len -= n;
+    }
+    CsHigh();
+}
+
+/**
+ *  @brief: write the same byte len times in one transaction
+ */
+void EpdIf::SpiWriteRepeat(unsigned char value, unsigned int len) {
+    CsLow();
+    while (len > 0) {
+        unsigned int n = len > SPI_STAGE_SIZE ? SPI_STAGE_SIZE : len;
+        memset(spi_stage, value, n);
+        Spi().transfer(spi_stage, n);
+        len -= n;
+    }
+    CsHigh();
+}
+
+/**
+ *  @brief: start streaming a RAM buffer through EasyDMA and return at once.
+ *          CS stays low until the last chunk has gone out, then done() is
+ *          called from SpiAsyncPoll(). Buffers outside RAM fall back to
+ *          SpiWriteBlock(). Returns -1 if a transfer is still in flight.
+ */
+int EpdIf::SpiWriteBlockAsync(const unsigned char* data, unsigned int len, EpdIfCallback done) {
+    if (async_active) {
+        return -1;
+    }
+    if (len == 0 || !IsInRam(data)) {
+        SpiWriteBlock(data, len);
+        if (done != NULL) {
+            done();
+        }
+        return 0;
+    }
+    async_data = data;
+    async_len = len;
+    async_done = done;
+    async_active = true;
+    async_cs = panels[active].cs;
+    CsLow();
+    DmaNextChunk();
+    return 0;
+}
+
+/**
+ *  @brief: advance the asynchronous transfer, chaining the next chunk when
+ *          the previous one has ended. Returns true while still busy.
+ */
+bool EpdIf::SpiAsyncPoll(void) {
+    if (!async_active) {
+        return false;
+    }
+    if (!DmaDone()) {
+        return true;
+    }
+    if (async_len > 0) {
+        DmaNextChunk();
+        return true;
+    }
+    EpdGpioWrite(async_cs, HIGH);
+    async_active = false;
+    if (async_done != NULL) {
+        async_done();
+    }
+    return async_active;
+}
+
+/**
+ *  @brief: block until BUSY goes LOW. The calling task sleeps on a semaphore
+ *          given by the BUSY falling-edge interrupt, so the core stays in
+ *          WFE instead of waking every few ms to poll the pin.
+ *          Once a mode has a few samples, the wait first sleeps for most of
+ *          its shortest learned duration in one block, so edges of other
+ *          panels on the shared semaphore do not wake it early.
+ *          Returns EPD_OK, or EPD_ERR_TIMEOUT after timeout_ms.
+ */
+int EpdIf::WaitBusyIdle(unsigned long timeout_ms) {
+    EpdPanel& p = panels[active];
+    unsigned char mode = p.busy_mode;
+    p.busy_mode = EPD_BUSY_OTHER;
+
+    unsigned long start = millis();
+    if (EpdGpioRead(p.busy) == LOW) {
+        return EPD_OK;
+    }
+    unsigned long hint = p.busy_model.SleepHint(mode);
+    if (hint > 0 && hint < timeout_ms) {
+        delay(hint);
+    }
+    while (EpdGpioRead(p.busy) == HIGH) {
+        unsigned long elapsed = millis() - start;
+        if (elapsed >= timeout_ms) {
+            EPD_LOG_E(EPD_EV_BUSY_TIMEOUT, mode, elapsed);
+            return EPD_ERR_TIMEOUT;
+        }
+        if (busy_sem == NULL) {
+            delay(1);   // IfInit() not run yet, no edge interrupt
+            continue;
+        }
+        /* a stale give from an earlier edge just loops back to the pin check */
+        xSemaphoreTake(busy_sem, pdMS_TO_TICKS(timeout_ms - elapsed));
+    }
+    unsigned long ms = millis() - start;
+    p.busy_model.Add(mode, ms);
+    if (mode != EPD_BUSY_OTHER) {
+        EPD_LOG_I(EPD_EV_BUSY_DONE, mode, ms);
+    }
+    return EPD_OK;
+}
+
+/**
+ *  @brief: clear the latched "refresh done" event. Call right before
+ *          triggering a refresh, then poll BusyDone().
+ */
+void EpdIf::BusyArm(void) {
+    EpdPanel& p = panels[active];
+    p.busy_edge = false;
+    p.busy_armed_at = millis();
+    p.busy_timing = true;
+}
+
+/**
+ *  @brief: non-blocking "refresh done" event. The first time it reports
+ *          a falling edge, the armed-to-edge time goes into the model.
+ */
+bool EpdIf::BusyDone(void) {
+    EpdPanel& p = panels[active];
+    if (p.busy_edge) {
+        if (p.busy_timing) {
+            p.busy_model.Add(p.busy_mode, p.busy_fell_at - p.busy_armed_at);
+            EPD_LOG_I(EPD_EV_BUSY_DONE, p.busy_mode, p.busy_fell_at - p.busy_armed_at);
+            p.busy_mode = EPD_BUSY_OTHER;
+            p.busy_timing = false;
+        }
+        return true;
+    }
+    return EpdGpioRead(p.busy) == LOW && millis() - p.busy_armed_at >= BUSY_RISE_MS;
+}
+
+/**
+ *  @brief: tag the next BUSY period of the active panel (EPD_BUSY_FULL,
+ *          EPD_BUSY_PART, ...). Untagged periods count as EPD_BUSY_OTHER.
+ */
+void EpdIf::SetBusyMode(unsigned char mode) {
+    panels[active].busy_mode = mode;
+}
+
+/**
+ *  @brief: learned BUSY durations of the active panel for one mode, for
+ *          planning render work around refreshes
+ */
+void EpdIf::GetBusyStats(unsigned char mode, EpdBusyStats* stats) {
+    panels[active].busy_model.Stats(mode, stats);
+}
+
+/**
+ *  @brief: execute a command table (see epdseq.h). CS stays low across
+ *          entries and DC is switched per byte, so a whole sequence is one
+ *          SPI transaction unless an entry waits for BUSY.
+ *          Returns EPD_OK, or the WaitBusyIdle() error.
+ */
+int EpdIf::RunSequence(const unsigned char* seq, unsigned long timeout_ms) {
+    CsLow();
+    while (seq[0] != EPD_SEQ_END) {
+        unsigned int len = seq[1] & EPD_SEQ_LEN_MASK;
+        DcPin::Low();
+        Spi().transfer(seq[0]);
+        if (len > 0) {
+            DcPin::High();
+            memcpy(spi_stage, seq + 2, len);
+            Spi().transfer(spi_stage, len);
+        }
+        if (seq[1] & EPD_SEQ_WAIT) {
+            CsHigh();
+            int ret = WaitBusyIdle(timeout_ms);
+            if (ret != EPD_OK) {
+                return ret;
+            }
+            CsLow();
+        }
+        seq += 2 + len;
+    }
+    CsHigh();
+    return EPD_OK;
+}
+
+/**
+ *  @brief: register another panel on the shared SPI/DC/RST lines.
+ *          RST is shared too, so resetting one panel resets all of them:
+ *          Init() every panel before starting refreshes.
+ *          Returns the panel index for SelectPanel(), or -1 if full.
+ */
+int EpdIf::AddPanel(unsigned long cs, unsigned long busy) {
+    if (panel_count >= EPD_MAX_PANELS) {
+        return -1;
+    }
+    EpdPanel& p = panels[panel_count];
+    p.cs = cs;
+    p.busy = busy;
+    p.clock = EPD_SPI_CLOCK_DEFAULT;
+    p.busy_edge = false;
+    p.busy_armed_at = 0;
+    p.busy_timing = false;
+    p.busy_mode = EPD_BUSY_OTHER;
+    p.busy_model = EpdBusyModel();
+    PanelPinInit(panel_count);
+    return panel_count++;
+}
+
+/**
+ *  @brief: route the following transfers and BUSY waits to a panel.
+ *          Refused (-1) while an EasyDMA transfer to another panel is
+ *          still running, since the bus is not free yet.
+ */
+int EpdIf::SelectPanel(int panel) {
+    if (panel < 0 || panel >= panel_count) {
+        return -1;
+    }
+    if (panel == active) {
+        return 0;
+    }
+    if (async_active) {
+        return -1;
+    }
+    unsigned long old_clock = panels[active].clock;
+    active = panel;
+    if (panels[active].clock != old_clock) {
+        Spi().endTransaction();
+        Spi().beginTransaction(SPISettings(panels[active].clock, MSBFIRST, SPI_MODE0));
+    }
+    return 0;
+}
+
+int EpdIf::ActivePanel(void) {
+    return active;
+}
+
+/**
+ *  @brief: true while an EasyDMA transfer holds the bus
+ */
+bool EpdIf::SpiBusy(void) {
+    return async_active;
+}
+
+/**
+ *  @brief: sleep until any panel's BUSY falls, or timeout_ms passes
+ */
+void EpdIf::WaitBusyEvent(unsigned long timeout_ms) {
+    if (busy_sem == NULL) {
+        delay(1);
+        return;
+    }
+    xSemaphoreTake(busy_sem, pdMS_TO_TICKS(timeout_ms));
+}
+
+int EpdIf::IfInit(void) {
+    pinMode(RST_PIN, OUTPUT);
+    pinMode(DC_PIN, OUTPUT);
+    if (busy_sem == NULL) {
+        busy_sem = xSemaphoreCreateBinary();
+    }
+    for (int i = 0; i < panel_count; i++) {
+        PanelPinInit(i);
+    }
+    
+    Spi().begin();
+    Spi().beginTransaction(SPISettings(panels[active].clock, MSBFIRST, SPI_MODE0));
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ *  @filename   :   epdif.h
+ *  @brief      :   Header file of epdif.cpp providing EPD interface functions
+ *                  shared by all panel drivers in lib/
+ *  @author     :   Yehui from Waveshare
+ *
+ *  Copyright (C) Waveshare     August 10 2017
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documnetation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to  whom the Software is
+ * furished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS OR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef EPDIF_H
+#define EPDIF_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "epdbus.h"
+#include "epdseq.h"
+#include "epdbusy.h"
+#include "epdlog.h"
+
+// Pin definition
+#define RST_PIN         NRF_GPIO_PIN_MAP(0, 22)
+#define DC_PIN          NRF_GPIO_PIN_MAP(0, 24)
+#define CS_PIN          NRF_GPIO_PIN_MAP(1, 00)
+#define BUSY_PIN        NRF_GPIO_PIN_MAP(0, 11)
+
+// SPI clock used until a driver calibrates a faster one, and the clock
+// used for RAM readback (the controllers read slower than they write)
+// (override per build with -D EPD_SPI_CLOCK_DEFAULT=...)
+#ifndef EPD_SPI_CLOCK_DEFAULT
+#define EPD_SPI_CLOCK_DEFAULT   2000000
+#endif
+#define EPD_SPI_CLOCK_READ      2000000
+
+// Read the panel's temperature sensor back (0x1B) to pick the LUT band.
+// Needs the panel SDA line wired to MISO; a floating or pulled-down MISO
+// reads 0 degC, so it is off unless the board has it
+// (override per build with -D EPD_READ_TEMP=1)
+#ifndef EPD_READ_TEMP
+#define EPD_READ_TEMP           0
+#endif
+
+// Panels sharing SPI, DC and RST, each with its own CS and BUSY line.
+// Panel 0 is CS_PIN/BUSY_PIN; more are registered with AddPanel().
+#ifndef EPD_MAX_PANELS
+#define EPD_MAX_PANELS      4
+#endif
+
+// Fill constant planes with the controller's auto write RAM commands
+// (0x46/0x47) instead of streaming the bytes; 0 = always stream
+// (override per build with -D EPD_RAM_AUTOFILL=0)
+#ifndef EPD_RAM_AUTOFILL
+#define EPD_RAM_AUTOFILL        1
+#endif
+// Longest an auto write RAM may keep BUSY high (a few ms in practice);
+// past it the fill has failed and EPD_EV_BUSY_TIMEOUT is logged
+#define EPD_AUTOFILL_TIMEOUT_MS 1000
+
+// WaitBusyIdle() return codes
+#define EPD_OK              0
+#define EPD_ERR_TIMEOUT     -2
+
+// RAM planes and EndFrame() refresh modes of the streaming API
+// (BeginFrame/WriteRows/EndFrame) every driver implements
+#define EPD_PLANE_BW        0x24
+#define EPD_PLANE_RED       0x26    // old image on B/W panels
+#define EPD_REFRESH_NONE    0       // plane written, more to follow
+#define EPD_REFRESH_FULL    1
+#define EPD_REFRESH_PART    2
+
+// Per-plane hints for DisplayFrame() on the tri-color drivers
+#define EPD_HINT_AUTO       0       // scan: fill on chip if blank, else write
+#define EPD_HINT_DIRTY      1       // always write
+#define EPD_HINT_CLEAN      2       // RAM already holds this plane, skip it
+#define EPD_HINT_EMPTY      3       // plane is blank, fill on chip without scanning
+#define EPD_HINT_HASH       4       // as AUTO, also skip if its 32-bit hash matches
+                                    // the last write (a collision keeps a stale plane)
+
+typedef void (*EpdIfCallback)(void);
+
+// Transport shared by all drivers, bound to the pins above at compile time
+typedef EpdBus<RST_PIN, DC_PIN, CS_PIN, BUSY_PIN, SPI> EpdDefaultBus;
+
+class EpdIf : public EpdDefaultBus {
+public:
+    EpdIf(void);
+    ~EpdIf(void);
+
+    static int  IfInit(void);
+    static void DigitalWrite(int pin, int value); 
+    static int  DigitalRead(int pin);
+    static void DelayMs(unsigned int delaytime);
+    static void SpiTransfer(unsigned char data);
+    static void SpiReadBlock(unsigned char* data, unsigned int len);
+    static void SetSpiClock(unsigned long hz);
+    static unsigned long GetSpiClock(void);
+    static void SpiWriteBlock(const unsigned char* data, unsigned int len);
+    static void SpiWriteRepeat(unsigned char value, unsigned int len);
+    static int  SpiWriteBlockAsync(const unsigned char* data, unsigned int len, EpdIfCallback done);
+    static bool SpiAsyncPoll(void);
+    static int  WaitBusyIdle(unsigned long timeout_ms);
+    static void BusyArm(void);
+    static bool BusyDone(void);
+    static void SetBusyMode(unsigned char mode);
+    static void GetBusyStats(unsigned char mode, EpdBusyStats* stats);
+    static int  RunSequence(const unsigned char* seq, unsigned long timeout_ms);
+
+    static int  AddPanel(unsigned long cs, unsigned long busy);
+    static int  SelectPanel(int panel);
+    static int  ActivePanel(void);
+    static bool SpiBusy(void);
+    static void WaitBusyEvent(unsigned long timeout_ms);
+};
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ *  @filename   :   epdlog.cpp
+ *  @brief      :   RAM ring buffer behind the EPD_LOG_* macros, see epdlog.h
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "epdlog.h"
+
+static EpdLogEntry ring[EPD_LOG_ENTRIES];
+static unsigned int head;           // next slot to write
+static unsigned int used;
+static unsigned long dropped;
+
+/**
+ *  @brief: append one event, overwriting the oldest when the ring is full.
+ *          Called from task context only, not from interrupt handlers.
+ */
+void EpdLog::Write(uint16_t id, uint16_t a, int32_t b) {
+    EpdLogEntry& e = ring[head];
+    e.time_ms = millis();
+    e.id = id;
+    e.a = a;
+    e.b = b;
+    head = (head + 1) % EPD_LOG_ENTRIES;
+    if (used < EPD_LOG_ENTRIES) {
+        used++;
+    } else {
+        dropped++;
+    }
+}
+
+/**
+ *  @brief: move up to max entries, oldest first, out of the ring.
+ *          lost receives the number of entries overwritten since the
+ *          previous Read (may be NULL).
+ *  @return: entries copied
+ */
+unsigned int EpdLog::Read(EpdLogEntry* out, unsigned int max, unsigned long* lost) {
+    unsigned int n = used < max ? used : max;
+    unsigned int tail = (head + EPD_LOG_ENTRIES - used) % EPD_LOG_ENTRIES;
+    for (unsigned int i = 0; i < n; i++) {
+        out[i] = ring[(tail + i) % EPD_LOG_ENTRIES];
+    }
+    used -= n;
+    if (lost != NULL) {
+        *lost = dropped;
+    }
+    dropped = 0;
+    return n;
+}
+
+/**
+ *  @brief: one entry as a dump line, "L tttttttt iiii aaaa bbbbbbbb"
+ *          in hex, for printing to Serial or a BLE UART
+ *  @return: characters written, excluding the NUL
+ */
+int EpdLog::Format(const EpdLogEntry* entry, char* line) {
+    return snprintf(line, EPD_LOG_LINE, "L %08lx %04x %04x %08lx",
+                    (unsigned long)entry->time_ms, entry->id, entry->a,
+                    (unsigned long)(uint32_t)entry->b);
+}
+
+/**
+ *  @brief: inverse of Format(); false when the line is not a dump line
+ */
+bool EpdLog::Parse(const char* line, EpdLogEntry* entry) {
+    unsigned long t, id, a, b;
+    if (sscanf(line, "L %8lx %4lx %4lx %8lx", &t, &id, &a, &b) != 4) {
+        return false;
+    }
+    entry->time_ms = t;
+    entry->id = id;
+    entry->a = a;
+    entry->b = (int32_t)(uint32_t)b;
+    return true;
+}
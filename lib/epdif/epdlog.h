@@ -0,0 +1,89 @@
+/**
+ *  @filename   :   epdlog.h
+ *  @brief      :   Event log shared by the drivers and the application.
+ *                  An event is a numeric ID, two arguments and a millis()
+ *                  timestamp written into a RAM ring buffer, so logging
+ *                  costs a few stores instead of a blocking UART print.
+ *                  The buffer is drained later (EpdLog::Read) as hex lines
+ *                  and turned back into text by tools/epdtrace/epdlogdump.
+ *
+ *                  Calls below EPD_LOG_LEVEL compile to nothing; a release
+ *                  build sets -D EPD_LOG_LEVEL=0 to drop them all.
+ */
+
+#ifndef EPDLOG_H
+#define EPDLOG_H
+
+#include <stdint.h>
+
+// Levels; an event is kept when its level <= EPD_LOG_LEVEL
+#define EPD_LOG_OFF         0
+#define EPD_LOG_ERROR       1
+#define EPD_LOG_INFO        2
+#define EPD_LOG_DEBUG       3
+
+#ifndef EPD_LOG_LEVEL
+#define EPD_LOG_LEVEL       EPD_LOG_INFO
+#endif
+
+// Entries kept; older ones are overwritten and counted as lost
+#ifndef EPD_LOG_ENTRIES
+#define EPD_LOG_ENTRIES     64
+#endif
+
+// Length of one formatted line including the terminating NUL
+#define EPD_LOG_LINE        32
+
+// Event table: name, ID, and names of the two arguments for the decoder.
+// IDs are part of the dump format; append new events, never renumber.
+#define EPD_LOG_EVENTS(X) \
+    X(EPD_EV_BUSY_DONE,       0x01, "busy-done",       "mode",   "ms") \
+    X(EPD_EV_BUSY_TIMEOUT,    0x02, "busy-timeout",    "mode",   "ms") \
+    X(EPD_EV_FULL_REFRESH,    0x10, "full-refresh",    "count",  "temp") \
+    X(EPD_EV_PART_REFRESH,    0x11, "part-refresh",    "bands",  "rows") \
+    X(EPD_EV_IMAGE_UNCHANGED, 0x12, "image-unchanged", "bytes",  "-")
+
+#define EPD_LOG_ENUM(name, id, text, a, b)  name = id,
+enum EpdLogEvent {
+    EPD_LOG_EVENTS(EPD_LOG_ENUM)
+};
+#undef EPD_LOG_ENUM
+
+struct EpdLogEntry {
+    uint32_t time_ms;
+    uint16_t id;
+    uint16_t a;
+    int32_t  b;
+};
+
+class EpdLog {
+public:
+    static void Write(uint16_t id, uint16_t a, int32_t b);
+    static unsigned int Read(EpdLogEntry* out, unsigned int max, unsigned long* lost);
+    static int  Format(const EpdLogEntry* entry, char* line);
+    static bool Parse(const char* line, EpdLogEntry* entry);
+};
+
+// A removed call still names its arguments (unevaluated, inside sizeof) so
+// variables kept only for logging do not trigger unused warnings
+#define EPD_LOG_NONE(id, a, b)  do { (void)sizeof((id) + (a) + (b)); } while (0)
+
+#if EPD_LOG_LEVEL >= EPD_LOG_ERROR
+#define EPD_LOG_E(id, a, b)     EpdLog::Write((id), (a), (b))
+#else
+#define EPD_LOG_E(id, a, b)     EPD_LOG_NONE(id, a, b)
+#endif
+
+#if EPD_LOG_LEVEL >= EPD_LOG_INFO
+#define EPD_LOG_I(id, a, b)     EpdLog::Write((id), (a), (b))
+#else
+#define EPD_LOG_I(id, a, b)     EPD_LOG_NONE(id, a, b)
+#endif
+
+#if EPD_LOG_LEVEL >= EPD_LOG_DEBUG
+#define EPD_LOG_D(id, a, b)     EpdLog::Write((id), (a), (b))
+#else
+#define EPD_LOG_D(id, a, b)     EPD_LOG_NONE(id, a, b)
+#endif
+
+#endif /* EPDLOG_H */
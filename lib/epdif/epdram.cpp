@@ -0,0 +1,394 @@
+/**
+ *  @filename   :   epdram.cpp
+ *  @brief      :   Controller RAM access shared by the panel drivers, see
+ *                  epdram.h
+ */
+
+#include <string.h>
+#include "epdram.h"
+
+// Clocks CalibrateSpiClock() tries in turn (the nRF52840 SPIM3 tops out at 32 MHz)
+static const unsigned long spi_clock_steps[] = {32000000, 16000000, 8000000, 4000000, 2000000};
+#define SPI_CAL_BYTES   16
+
+EpdRam::EpdRam(int row_bytes, int height, unsigned long spi_clock_max) {
+    ram_row_bytes = row_bytes;
+    ram_height = height;
+    this->spi_clock_max = spi_clock_max;
+    readback_diff = false;
+    stream_rows = -1;
+    ForgetPlanes();
+}
+
+/**
+ *  @brief: basic function for sending commands
+ */
+void EpdRam::SendCommand(unsigned char command) {
+    DcPin::Low();
+    SpiTransfer(command);
+}
+
+/**
+ *  @brief: basic function for sending data
+ */
+void EpdRam::SendData(unsigned char data) {
+    DcPin::High();
+    SpiTransfer(data);
+}
+
+/**
+ *  @brief: send a block of data in a single SPI transaction
+ */
+void EpdRam::SendDataBlock(const unsigned char* data, unsigned int len) {
+    DcPin::High();
+    SpiWriteBlock(data, len);
+}
+
+/**
+ *  @brief: send the same data byte len times in a single SPI transaction
+ */
+void EpdRam::SendDataRepeat(unsigned char value, unsigned int len) {
+    DcPin::High();
+    SpiWriteRepeat(value, len);
+}
+
+/**
+ *  @brief: send a command followed by its payload
+ */
+void EpdRam::SendCommandData(unsigned char command, const unsigned char* data, unsigned int len) {
+    SendCommand(command);
+    SendDataBlock(data, len);
+}
+
+/**
+ *  @brief: read data bytes from the controller
+ */
+void EpdRam::ReadData(unsigned char* data, unsigned int len) {
+    DcPin::High();
+    SpiReadBlock(data, len);
+}
+
+/**
+ *  @brief: forget what the RAM planes hold, after anything that may have
+ *          changed them behind WritePlane()'s back (reset, async upload)
+ */
+void EpdRam::ForgetPlanes(void) {
+    plane_state[0] = plane_state[1] = EPD_RAM_UNKNOWN;
+}
+
+/**
+ *  @brief: start streaming a frame into one RAM plane, top row first; the
+ *          rows follow with WriteRows() and the driver's EndFrame() ends it
+ *  @param: plane: EPD_PLANE_BW or EPD_PLANE_RED
+ *  @return: 0, or -1 for an unknown plane
+ */
+int EpdRam::BeginRows(unsigned char plane) {
+    if (plane != EPD_PLANE_BW && plane != EPD_PLANE_RED) {
+        return -1;
+    }
+    SetRamWindow(0, 0, ram_row_bytes, ram_height);
+    SendCommand(plane);
+    stream_rows = 0;
+    plane_state[plane == EPD_PLANE_RED] = EPD_RAM_UNKNOWN;
+    return 0;
+}
+
+/**
+ *  @brief: send the next band of the frame started with BeginFrame()
+ *  @param: rows: row_count rows of the panel's row bytes each
+ *          row_count: band height; rows past the bottom of the panel are dropped
+ *  @return: number of rows sent, -1 if no frame is being streamed
+ */
+int EpdRam::WriteRows(const unsigned char* rows, int row_count) {
+    if (stream_rows < 0) {
+        return -1;
+    }
+    if (row_count > ram_height - stream_rows) {
+        row_count = ram_height - stream_rows;
+    }
+    if (row_count <= 0) {
+        return 0;
+    }
+    SendDataBlock(rows, row_count * ram_row_bytes);
+    stream_rows += row_count;
+    return row_count;
+}
+
+/**
+ *  @brief: finish the streamed plane; rows that were not sent keep their
+ *          previous RAM content
+ *  @return: 0, or -1 if no frame is being streamed
+ */
+int EpdRam::EndRows(void) {
+    if (stream_rows < 0) {
+        return -1;
+    }
+    stream_rows = -1;
+    return 0;
+}
+
+/**
+ *  @brief: fill a whole RAM plane with 0x00 or 0xFF. Uses the controller's
+ *          auto write RAM (0x47 for 0x24, 0x46 for 0x26): one command byte
+ *          instead of a frame of data. BUSY is waited for once, up to
+ *          EPD_AUTOFILL_TIMEOUT_MS; a fill still running then has failed
+ *          and the plane's content is unknown.
+ *          Streams the bytes only when EPD_RAM_AUTOFILL is 0.
+ *  @param: ram: 0x24 or 0x26
+ *          value: 0x00 or 0xFF
+ */
+void EpdRam::FillRam(unsigned char ram, unsigned char value) {
+    plane_state[ram == 0x26] = value == (ram == 0x26 ? 0x00 : 0xFF) ? EPD_RAM_BLANK : EPD_RAM_UNKNOWN;
+    SetRamWindow(0, 0, ram_row_bytes, ram_height);  // the fill covers the current window
+#if EPD_RAM_AUTOFILL
+    SendCommand(ram == 0x26 ? 0x46 : 0x47);
+    SendData(value ? 0xF7 : 0x77);      // first step value, step height and width beyond the panel
+    if (WaitBusyIdle(EPD_AUTOFILL_TIMEOUT_MS) != EPD_OK) {
+        plane_state[ram == 0x26] = EPD_RAM_UNKNOWN;     // timeout logged by WaitBusyIdle()
+    }
+#else
+    SendCommand(ram);
+    SendDataRepeat(value, ram_row_bytes * ram_height);
+#endif
+}
+
+/**
+ *  @brief: scan a plane a 32-bit word at a time for being all blank, and
+ *          hash it on the way (FNV-1a per word). A few thousand loads and
+ *          multiplies, far cheaper than sending the plane over SPI.
+ *  @return: true if every byte is blank
+ */
+static bool ScanPlane(const unsigned char* frame, unsigned int len, unsigned char blank, uint32_t* sum) {
+    const uint32_t blank_word = blank * 0x01010101UL;
+    uint32_t diff = 0;
+    uint32_t hash = 2166136261UL;
+    unsigned int i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint32_t word;
+        memcpy(&word, frame + i, 4);
+        diff |= word ^ blank_word;
+        hash = (hash ^ word) * 16777619UL;
+    }
+    for (; i < len; i++) {
+        diff |= frame[i] ^ blank;
+        hash = (hash ^ frame[i]) * 16777619UL;
+    }
+    *sum = hash;
+    return diff == 0;
+}
+
+/**
+ *  @brief: write one whole RAM plane according to a hint.
+ *          EPD_HINT_AUTO: a blank plane is filled on chip, or skipped if RAM
+ *          is already blank; any other plane is written in full.
+ *          EPD_HINT_HASH: as AUTO, and also skipped if its hash matches the
+ *          last write. The hash is 32 bits, so about 2^-32 of changed planes
+ *          collide and leave the old frame on the panel; callers that must
+ *          never miss an update do not pass EPD_HINT_HASH.
+ *  @param: ram: 0x24 or 0x26
+ *          frame: the whole plane, NULL counts as blank
+ *          hint: EPD_HINT_*
+ */
+void EpdRam::WritePlane(unsigned char ram, const unsigned char* frame, int hint) {
+    int plane = ram == 0x26;
+    unsigned char blank = plane ? 0x00 : 0xFF;
+    unsigned int len = ram_row_bytes * ram_height;
+    uint32_t sum = 0;
+
+    if (hint == EPD_HINT_CLEAN) {
+        return;
+    }
+    if (frame == NULL || hint == EPD_HINT_EMPTY || ScanPlane(frame, len, blank, &sum)) {
+        if (hint == EPD_HINT_DIRTY || plane_state[plane] != EPD_RAM_BLANK) {
+            FillRam(ram, blank);
+        }
+        return;
+    }
+    if (hint == EPD_HINT_HASH && plane_state[plane] == EPD_RAM_DATA && plane_sum[plane] == sum) {
+        return;
+    }
+    if (readback_diff) {
+        WriteChangedRows(ram, frame);
+    } else {
+        SetRamWindow(0, 0, ram_row_bytes, ram_height);
+        SendCommandData(ram, frame, len);
+    }
+    plane_state[plane] = EPD_RAM_DATA;
+    plane_sum[plane] = sum;
+}
+
+/**
+ *  @brief: enable or disable the readback diff of whole-frame writes.
+ *          Instead of keeping a shadow copy of the last frame, the current
+ *          RAM is read back (0x27) row by row and only rows that differ are
+ *          written. Needs the panel SDA line wired to MISO, see SpiReadBlock().
+ */
+void EpdRam::SetReadbackDiff(bool enable) {
+    readback_diff = enable;
+}
+
+/**
+ *  @brief: write only the rows of a frame that differ from the controller
+ *          RAM. Pass 1 reads every row back at EPD_SPI_CLOCK_READ and marks
+ *          the changed ones, pass 2 writes each run of changed rows in one
+ *          transfer. Leaves the address counter at row 0.
+ *  @param: ram: 0x24 (B/W) or 0x26 (red / old image)
+ *          frame: the whole plane
+ *  @return: number of rows written
+ */
+int EpdRam::WriteChangedRows(unsigned char ram, const unsigned char* frame) {
+    unsigned char row[EPD_RAM_MAX_ROW_BYTES + 1];
+    unsigned char dirty[(EPD_RAM_MAX_HEIGHT + 7) / 8];
+    unsigned long write_clock = GetSpiClock();
+    int written = 0;
+
+    memset(dirty, 0, sizeof(dirty));
+    SetRamWindow(0, 0, ram_row_bytes, ram_height);
+    SetSpiClock(EPD_SPI_CLOCK_READ);
+    SendCommand(0x41);  // read RAM option
+    SendData(ram == 0x26 ? 0x01 : 0x00);
+    for (int y = 0; y < ram_height; y++) {
+        SetCursorRow(y);
+        SendCommand(0x27);  // read RAM, first byte is a dummy
+        ReadData(row, ram_row_bytes + 1);
+        if (memcmp(row + 1, frame + y * ram_row_bytes, ram_row_bytes) != 0) {
+            dirty[y >> 3] |= 1 << (y & 7);
+        }
+    }
+    SetSpiClock(write_clock);
+
+    for (int y = 0; y < ram_height; ) {
+        if (!(dirty[y >> 3] & (1 << (y & 7)))) {
+            y++;
+            continue;
+        }
+        int end = y + 1;
+        while (end < ram_height && (dirty[end >> 3] & (1 << (end & 7)))) {
+            end++;
+        }
+        SetCursorRow(y);
+        SendCommandData(ram, frame + y * ram_row_bytes, (end - y) * ram_row_bytes);
+        written += end - y;
+        y = end;
+    }
+    SetCursorRow(0);
+    return written;
+}
+
+/**
+ *  @brief: write a rectangle of a whole-frame buffer to the same place in RAM
+ *  @param: rect: in pixels, x and w widened to whole bytes
+ */
+void EpdRam::WriteFrameRect(unsigned char ram, const unsigned char* frame, const EpdRect& rect) {
+    int x = rect.x < 0 ? 0 : rect.x;
+    int y = rect.y < 0 ? 0 : rect.y;
+    int right = rect.x + rect.w < ram_row_bytes * 8 ? rect.x + rect.w : ram_row_bytes * 8;
+    int bottom = rect.y + rect.h < ram_height ? rect.y + rect.h : ram_height;
+    if (right <= x || bottom <= y) {
+        return;
+    }
+    int xb = x >> 3;
+    int wb = ((right - 1) >> 3) - xb + 1;
+    WriteWindow(ram, frame + y * ram_row_bytes + xb, ram_row_bytes, xb, y, wb, bottom - y);
+}
+
+/**
+ *  @brief: write an image into a RAM window, without refreshing. Parts
+ *          outside the panel are clipped. The window is left set; every
+ *          whole-plane write sets the full window again first.
+ *  @param: ram: 0x24 or 0x26
+ *          data: top left byte of the image, stride bytes per row (NULL: nothing)
+ *          xb, wb: window left edge and width in bytes
+ *          y, h: window top row and number of rows
+ */
+void EpdRam::WriteWindow(unsigned char ram, const unsigned char* data, int stride, int xb, int y, int wb, int h) {
+    if (data == NULL) {
+        return;
+    }
+    if (xb < 0) {
+        data -= xb;
+        wb += xb;
+        xb = 0;
+    }
+    if (y < 0) {
+        data -= y * stride;
+        h += y;
+        y = 0;
+    }
+    if (xb + wb > ram_row_bytes) {
+        wb = ram_row_bytes - xb;
+    }
+    if (y + h > ram_height) {
+        h = ram_height - y;
+    }
+    if (wb <= 0 || h <= 0) {
+        return;
+    }
+    plane_state[ram == 0x26] = EPD_RAM_UNKNOWN;
+
+    SetRamWindow(xb, y, wb, h);
+    if (stride == wb) {
+        SendCommandData(ram, data, wb * h);     // a packed window image goes in one transfer
+    } else {
+        SendCommand(ram);
+        for (int row = 0; row < h; row++) {
+            SendDataBlock(data + row * stride, wb);
+        }
+    }
+}
+
+/**
+ *  @brief: pick the fastest SPI write clock the panel verifies at.
+ *          Writes a test pattern to RAM 0x24 at each stepped clock and reads
+ *          it back (0x27) at EPD_SPI_CLOCK_READ. Call after Init() and before
+ *          drawing, since it overwrites the first RAM row.
+ *  @return: the selected clock in Hz, or 0 if no rate verified (clock unchanged)
+ */
+unsigned long EpdRam::CalibrateSpiClock(void) {
+    unsigned long old_clock = GetSpiClock();
+    plane_state[0] = EPD_RAM_UNKNOWN;   // the pattern lands in the first row of 0x24
+    for (unsigned int i = 0; i < sizeof(spi_clock_steps) / sizeof(spi_clock_steps[0]); i++) {
+        if (spi_clock_steps[i] > spi_clock_max) {
+            continue;
+        }
+        if (VerifySpiClock(spi_clock_steps[i], (unsigned char)(i * 0x3B))) {
+            SetSpiClock(spi_clock_steps[i]);
+            return spi_clock_steps[i];
+        }
+    }
+    SetSpiClock(old_clock);
+    return 0;
+}
+
+/**
+ *  @brief: write the calibration pattern at hz and check it reads back.
+ *          The window and the inverse pattern go first at the default
+ *          clock, so a write dropped at hz cannot match what an earlier
+ *          step left in the row; seed varies the pattern per step.
+ */
+bool EpdRam::VerifySpiClock(unsigned long hz, unsigned char seed) {
+    unsigned char pattern[SPI_CAL_BYTES];
+    unsigned char readback[SPI_CAL_BYTES + 1];
+
+    for (int i = 0; i < SPI_CAL_BYTES; i++) {
+        pattern[i] = ((i & 1) ? 0xA5 : (unsigned char)(0x5A ^ i)) ^ seed;
+        readback[i] = ~pattern[i];
+    }
+
+    SetSpiClock(EPD_SPI_CLOCK_DEFAULT);
+    SetRamWindow(0, 0, ram_row_bytes, ram_height);
+    SendCommandData(0x24, readback, SPI_CAL_BYTES);
+    SetCursorRow(0);
+
+    SetSpiClock(hz);
+    SendCommandData(0x24, pattern, SPI_CAL_BYTES);
+
+    SetSpiClock(EPD_SPI_CLOCK_READ);
+    SetCursorRow(0);
+    SendCommand(0x41);  // read RAM option: 0x24
+    SendData(0x00);
+    SendCommand(0x27);  // read RAM, first byte is a dummy
+    ReadData(readback, SPI_CAL_BYTES + 1);
+
+    return memcmp(pattern, readback + 1, SPI_CAL_BYTES) == 0;
+}
@@ -0,0 +1,75 @@
+/**
+ *  @filename   :   epdram.h
+ *  @brief      :   Controller RAM access shared by the SSD1680/SSD1683
+ *                  drivers: the command/data primitives, row streaming,
+ *                  on-chip fills, windowed writes, whole-plane writes with
+ *                  blank detection, the readback diff and the SPI clock
+ *                  calibration.
+ *
+ *                  Nothing here depends on the panel size or the data entry
+ *                  mode. A driver passes its row bytes and height and
+ *                  implements the two addressing calls, SetRamWindow() and
+ *                  SetCursorRow(), in frame coordinates (row 0 at the top).
+ */
+
+#ifndef EPDRAM_H
+#define EPDRAM_H
+
+#include <stdint.h>
+#include "epdif.h"
+#include "epddiff.h"
+
+// Largest panel the stack buffers of the readback diff are sized for (4.2")
+#define EPD_RAM_MAX_ROW_BYTES   50
+#define EPD_RAM_MAX_HEIGHT      300
+
+// Known content of a RAM plane (plane_state), lets WritePlane() skip work
+#define EPD_RAM_UNKNOWN     0
+#define EPD_RAM_BLANK       1       // the plane's blank value (0x24: 0xFF, 0x26: 0x00)
+#define EPD_RAM_DATA        2       // a frame written by WritePlane(), hashed
+
+class EpdRam : protected EpdIf {
+public:
+    EpdRam(int row_bytes, int height, unsigned long spi_clock_max);
+
+    // virtual so a driver that shadows controller state can see RAM commands
+    virtual void SendCommand(unsigned char command);
+    void SendData(unsigned char data);
+    void SendDataBlock(const unsigned char* data, unsigned int len);
+    void SendDataRepeat(unsigned char value, unsigned int len);
+    void SendCommandData(unsigned char command, const unsigned char* data, unsigned int len);
+    void ReadData(unsigned char* data, unsigned int len);
+    unsigned long CalibrateSpiClock(void);
+    void SetReadbackDiff(bool enable);
+    int  WriteRows(const unsigned char* rows, int row_count);
+
+protected:
+    /* RAM window over byte columns xb..xb+wb-1 and rows y..y+h-1, with the
+     * address counter at its top left corner */
+    virtual void SetRamWindow(int xb, int y, int wb, int h) = 0;
+    /* address counter to column 0 of row y, inside the full window */
+    virtual void SetCursorRow(int y) = 0;
+
+    int  BeginRows(unsigned char plane);
+    int  EndRows(void);
+    void FillRam(unsigned char ram, unsigned char value);
+    void WritePlane(unsigned char ram, const unsigned char* frame, int hint);
+    int  WriteChangedRows(unsigned char ram, const unsigned char* frame);
+    void WriteWindow(unsigned char ram, const unsigned char* data, int stride, int xb, int y, int wb, int h);
+    void WriteFrameRect(unsigned char ram, const unsigned char* frame, const EpdRect& rect);
+    void ForgetPlanes(void);
+
+    bool readback_diff;
+    int stream_rows;                // rows sent since BeginRows(), -1 outside a frame
+    unsigned char plane_state[2];   // known content of 0x24/0x26 (EPD_RAM_*)
+
+private:
+    bool VerifySpiClock(unsigned long hz, unsigned char seed);
+
+    int ram_row_bytes;
+    int ram_height;
+    unsigned long spi_clock_max;
+    uint32_t plane_sum[2];          // content hash while EPD_RAM_DATA
+};
+
+#endif /* EPDRAM_H */
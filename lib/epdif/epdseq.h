@@ -0,0 +1,36 @@
+/**
+ *  @filename   :   epdseq.h
+ *  @brief      :   Declarative controller command sequences, executed by
+ *                  EpdIf::RunSequence() in a single SPI transaction.
+ *
+ *                  A sequence is a flat byte table of entries
+ *                      opcode, length [| EPD_SEQ_WAIT], payload[length]
+ *                  closed by EPD_SEQ_END. EPD_SEQ_WAIT waits for BUSY after
+ *                  the entry. Declare tables constexpr and check them with
+ *                  EPD_SEQ_CHECK so a wrong length fails the build:
+ *
+ *                      static constexpr unsigned char seq[] = {
+ *                          0x12, 0 | EPD_SEQ_WAIT,
+ *                          0x11, 1, 0x03,
+ *                          EPD_SEQ_END
+ *                      };
+ *                      EPD_SEQ_CHECK(seq);
+ */
+
+#ifndef EPDSEQ_H
+#define EPDSEQ_H
+
+#define EPD_SEQ_WAIT        0x80
+#define EPD_SEQ_LEN_MASK    0x7F
+#define EPD_SEQ_END         0xFF    // not a command on SSD1680/SSD1683
+
+constexpr bool EpdSeqValid(const unsigned char* seq, unsigned int size, unsigned int pos) {
+    return pos + 1 == size ? seq[pos] == EPD_SEQ_END
+         : pos + 1 < size && seq[pos] != EPD_SEQ_END &&
+           EpdSeqValid(seq, size, pos + 2 + (seq[pos + 1] & EPD_SEQ_LEN_MASK));
+}
+
+#define EPD_SEQ_CHECK(seq) \
+    static_assert(EpdSeqValid(seq, sizeof(seq), 0), #seq ": entry length does not match payload")
+
+#endif /* EPDSEQ_H */
@@ -1,5 +1,6 @@
 #include "epd2in13_V3.h" 
 #include "epdpaint.h"
+#include "epddiff.h"
 #include <TimeLib.h>
 #include <bluefruit.h>
 
@@ -9,6 +10,24 @@ int prevSecond = -1;
 int refresh_count = 0; 
 bool isFirstUpdate = true; 
 
+// 全刷间隔 (局刷次数)：低温下局刷残影更重，缩短间隔
+#define FULL_REFRESH_EVERY       600
+#define FULL_REFRESH_EVERY_COLD  180
+
+// 一次局刷最多写入的窗口数 (如秒区 + 分钟卡片)，多出的会合并
+#define MAX_DIFF_BANDS  3
+
+// 默认只显示到分钟：每分钟一次局刷，两次之间屏幕深度睡眠 (见 idleDisplay)。
+// 编译时 -D SHOW_SECONDS=1 显示秒，每秒一次局刷，屏幕一直待机不睡眠
+#ifndef SHOW_SECONDS
+#define SHOW_SECONDS    0
+#endif
+
+// 下一次刷新至少隔这么多秒才进深度睡眠。每次唤醒都要复位脉冲、重发 159 字节
+// LUT 和局刷初始化，间隔短时不如保持待机：每次刷新 (0x22 = 0xCF / 0xC7) 自己打开
+// 时钟和模拟电路，结束时再关掉，所以两次刷新之间两者都是关的
+#define SLEEP_MIN_GAP_S 20
+
 // --- 颜色定义 ---
 #define COLORED     0  // 黑色
 #define UNCOLORED   1  // 白色
@@ -18,6 +37,22 @@ Epd epd;
 unsigned char image[4000]; 
 Paint paint(image, 0, 0); 
 
+// 屏上当前内容的副本，用来找出下一帧真正变化的区域 (每行 16 字节，共 250 行)
+static unsigned char shadow[4000];
+EpdDiff frameDiff(shadow, 16, 250);
+
+// 距离下一次画面变化的秒数
+static int secondsToNextUpdate() {
+  return SHOW_SECONDS ? 1 : 60 - second();
+}
+
+// 刷新后：下一次刷新还远才睡眠，否则保持待机，下一次 Init(PART) 什么都不发
+static void idleDisplay() {
+  if (secondsToNextUpdate() >= SLEEP_MIN_GAP_S) {
+    epd.Sleep();          // 深度睡眠保留 RAM，下一次 Init(PART) 只需复位脉冲
+  }
+}
+
 // 辅助函数：居中X坐标
 int getCenterX(const char* text, sFONT* font) {
     int textWidth = strlen(text) * font->Width;
@@ -105,9 +140,11 @@ void updateClockDisplay() {
   // ==========================================
   
   // 秒 (底部大号数字，无框，极简)
-  sprintf(buf, "%02d", second());
   int sX = (122 - (2 * Font24.Width)) / 2;
-  paint.DrawStringAt(sX, 195, buf, &Font24, COLORED);
+  if (SHOW_SECONDS) {
+    sprintf(buf, "%02d", second());
+    paint.DrawStringAt(sX, 195, buf, &Font24, COLORED);
+  }
   
   // 秒下面的小横线装饰
   paint.DrawHorizontalLine(sX, 220, 2 * Font24.Width, COLORED);
@@ -121,17 +158,33 @@ void updateClockDisplay() {
 
   // ==========================================
   // 刷新策略
-  // 每 10 分钟 (600秒) 全刷，或者 00分00秒  整时全刷
-  if (isFirstUpdate || refresh_count >= 600 || (minute() == 0 && second() == 0)) {
-      Serial.println(">> FULL Refresh");
+  // 每 10 分钟 (600秒，低温时 3 分钟) 全刷，或者 00分00秒  整时全刷
+  int temp = epd.Temperature();
+  int fullEvery = (temp != EPD_TEMP_UNKNOWN && temp < EPD_TEMP_COLD) ? FULL_REFRESH_EVERY_COLD : FULL_REFRESH_EVERY;
+  if (isFirstUpdate || refresh_count >= fullEvery || (minute() == 0 && second() == 0)) {
+      EPD_LOG_I(EPD_EV_FULL_REFRESH, refresh_count, temp);   // 不在刷新路径上同步打印串口
       epd.Init(FULL);       
       epd.Display(image);   
-      epd.Init(PART);       
+      idleDisplay();
+      frameDiff.Commit(image);
       refresh_count = 0;
       isFirstUpdate = false; 
   } else {
-      epd.Init(PART);       
-      epd.DisplayPart(image); 
+      // 只把变化的行带写进 RAM，再统一局刷一次；画面没变则什么都不发
+      EpdRect bands[MAX_DIFF_BANDS];
+      int n = frameDiff.Bands(image, bands, MAX_DIFF_BANDS);
+      if (n > 0) {
+          epd.Init(PART);       // 待机中已是局刷模式则不发送任何数据；睡眠后要复位并重发 LUT 和初始化
+          int rows = 0;
+          for (int i = 0; i < n; i++) {
+              epd.WritePartWindow(image, bands[i].x, bands[i].y, bands[i].w, bands[i].h);
+              rows += bands[i].h;
+          }
+          epd.RefreshPart();
+          idleDisplay();
+          frameDiff.Commit(image);
+          EPD_LOG_D(EPD_EV_PART_REFRESH, n, rows);
+      }
       refresh_count++;
   }
 }
@@ -180,5 +233,6 @@ void setupDisplay() {
  
 
   epd.Display(image);
+  frameDiff.Commit(image);
 
 }
\ No newline at end of file
@@ -1,10 +1,12 @@
 #include <bluefruit.h>
 #include "epd2in13_V3.h" 
+#include "epddiff.h"
 
 BLEUart bleuart;
 extern int refresh_count;
 extern Epd epd;
 extern unsigned char image[4000]; 
+extern EpdDiff frameDiff;
 
 // --- 数据接收缓冲 ---
 // 2.13寸屏 V3 分辨率 122x250
@@ -74,9 +76,16 @@ void handleBLEUart(void) {
            // 将接收到的数据复制到显存并显示
            memcpy(image, rxBuffer, 3813);
            
-           epd.Init(FULL); // 图片建议全刷，清晰
-           epd.Display(image);
-           epd.Init(PART); // 刷完休眠或准备局刷
+           // 与屏上内容完全相同 (重复发送) 时不刷新
+           EpdRect box;
+           if (frameDiff.Compare(image, &box)) {
+             epd.Init(FULL); // 图片建议全刷，清晰
+             epd.Display(image, EPD_QUALITY_FAST); // 交互推送用快速全刷波形，定时全刷仍用高质量
+             epd.Init(PART); // 刷完休眠或准备局刷
+             frameDiff.Commit(image);
+           } else {
+             EPD_LOG_D(EPD_EV_IMAGE_UNCHANGED, 3813, 0);   // 不在接收路径上同步打印串口
+           }
            
            isReceivingImage = false;
            rxIndex = 0;
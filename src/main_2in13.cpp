@@ -48,6 +48,7 @@ extern unsigned char image[4000];
 void setup() {
   Serial.begin(115200);
 
+  epd.SetPingPong(true);  // 全刷后也写 0x26，局刷直接接在 Display()/Clear() 之后，不用 DisplayPartBaseImage()
   epd.Init(FULL); 
   epd.Clear(); 
   Serial.println("Initializing display...");
@@ -61,8 +62,30 @@ void setup() {
   
 }
 
+// 串口收到 'L' 时把事件日志按十六进制行打印出来，
+// 用 tools/epdtrace/epdlogdump 解码 (不在刷新路径上写串口)
+void dumpEventLog() {
+  EpdLogEntry entries[8];
+  char line[EPD_LOG_LINE];
+  unsigned long lost;
+  unsigned int n;
+  while ((n = EpdLog::Read(entries, 8, &lost)) > 0) {
+    if (lost > 0) {
+      snprintf(line, sizeof(line), "L lost %lu", lost);
+      Serial.println(line);
+    }
+    for (unsigned int i = 0; i < n; i++) {
+      EpdLog::Format(&entries[i], line);
+      Serial.println(line);
+    }
+  }
+}
+
 void loop() {
   handleBLEUart();
+  if (Serial.available() && Serial.read() == 'L') {
+    dumpEventLog();
+  }
   if (second() != prevSecond && year() > 2000) {
     prevSecond = second();
     updateClockDisplay();
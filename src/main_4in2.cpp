@@ -72,7 +72,10 @@ void setup() {
   // 5. 发送数据并刷新
   // 这一步调用的是你刚刚修改过的 DisplayFrame
   Serial.println("Displaying Frame...");
-  epd.DisplayFrame(imageBlack, imageRed);
+  // 红色只有标题和一张小图：0x26 片上清空，只上传红色内容的包围盒
+  EpdRect redBox;
+  paintRed.GetBounds(&redBox);
+  epd.DisplayFrameRedBox(imageBlack, imageRed, redBox);
   
   // 6. 进入休眠
   // 刷新完成后必须休眠，否则 SSD1683 芯片会持续发热并损坏屏幕
@@ -0,0 +1,35 @@
+/**
+ *  @filename   :   epdhost.h
+ *  @brief      :   Control API of the recording EpdIf used by host builds.
+ *                  Everything the drivers send is recorded to a trace (see
+ *                  epdtrace.h) and fed to a PanelModel. Time is virtual:
+ *                  SPI bytes cost 8 bit times at the current clock, delays
+ *                  and BUSY periods advance the clock by their length.
+ */
+
+#ifndef EPDHOST_H
+#define EPDHOST_H
+
+#include "panel_model.h"
+
+int  EpdHostOpen(const char* path, int width_px, int height, int flags);
+void EpdHostClose(void);
+
+/* Start a named phase; epdreplay reports bytes and time per phase */
+void EpdHostMark(const char* label);
+
+/* Let virtual time pass, e.g. the main loop doing other work between
+ * SpiAsyncPoll()/BusyDone() calls */
+void EpdHostAdvance(unsigned long us);
+
+/* Temperature the panel's internal sensor reports from now on */
+void EpdHostSetTemperature(int celsius);
+
+/* Fastest SPI clock the panel latches data bytes at; faster ones never
+ * reach it (nor the trace). 0 = no limit */
+void EpdHostSetSpiLimit(unsigned long hz);
+
+unsigned long long EpdHostNowUs(void);
+PanelModel& EpdHostPanel(void);
+
+#endif
@@ -0,0 +1,517 @@
+/**
+ *  @filename   :   epdif_host.cpp
+ *  @brief      :   Recording EpdIf for native Linux builds (EPDIF_HOST).
+ *                  Implements the same interface as lib/epdif/epdif.cpp, but
+ *                  instead of driving GPIO and SPIM it appends every command,
+ *                  data byte, pin transition, delay and BUSY wait to a trace
+ *                  file and replays the traffic into a PanelModel.
+ *
+ *                  The BUSY model below gives rough per-operation durations
+ *                  so time budgets include the refresh itself. The EasyDMA
+ *                  path completes transfers on the virtual clock, which lets
+ *                  host code drive the async state machines.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "epdif.h"
+#include "epdhost.h"
+#include "epdtrace.h"
+
+HostSerial Serial;
+SPIClass SPI;
+
+static FILE* trace = NULL;
+static PanelModel* panel = NULL;
+
+static unsigned long long now_ns = 0;
+static unsigned long long last_record_us = 0;
+static unsigned long spi_clock = EPD_SPI_CLOCK_DEFAULT;
+static unsigned long spi_limit = 0;
+
+static int pin_level[64];
+static unsigned long long busy_until_ns = 0;
+
+static std::vector<unsigned char> data_run;
+static unsigned long long data_run_us;
+
+/* The model is a single panel; extra panels only get their CS recorded */
+static unsigned long panel_cs[EPD_MAX_PANELS] = { CS_PIN };
+static int panel_count = 1;
+static int active = 0;
+
+static EpdBusyModel busy_model;
+static unsigned char busy_mode = EPD_BUSY_OTHER;
+static unsigned long long busy_armed_ns;
+static bool busy_timing = false;
+
+static bool async_active = false;
+static unsigned long long async_done_ns;
+static EpdIfCallback async_done;
+
+/* -------------------------------------------------------------------------
+ * trace writer
+ * ---------------------------------------------------------------------- */
+
+static void PutVarint(unsigned long long value) {
+    do {
+        unsigned char b = value & 0x7F;
+        value >>= 7;
+        if (value) {
+            b |= 0x80;
+        }
+        fputc(b, trace);
+    } while (value);
+}
+
+static void PutHeader(unsigned char tag, unsigned long long at_us) {
+    fputc(tag, trace);
+    PutVarint(at_us - last_record_us);
+    last_record_us = at_us;
+}
+
+static void FlushData(void) {
+    if (data_run.empty()) {
+        return;
+    }
+    if (trace) {
+        PutHeader(TRACE_DATA, data_run_us);
+        PutVarint(data_run.size());
+        fwrite(&data_run[0], 1, data_run.size(), trace);
+    }
+    data_run.clear();
+}
+
+static void Record(unsigned char tag) {
+    FlushData();
+    if (trace) {
+        PutHeader(tag, now_ns / 1000);
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * panel side
+ * ---------------------------------------------------------------------- */
+
+/* Rough BUSY durations of the SSD168x operations the drivers trigger */
+static unsigned long BusyTimeUs(unsigned char command, unsigned char update_ctrl) {
+    if (command == 0x12) {
+        return 2000;                        // SW reset
+    }
+    if (command == 0x46 || command == 0x47) {
+        return 2000;                        // auto write RAM
+    }
+    switch (update_ctrl) {
+    case 0xF7: return 15000000;             // tri-color full refresh
+    case 0xC7:                              // B/W full refresh
+        return panel->FastLut() ? 1500000 : 2000000;
+    case 0x0F:
+    case 0x0C:
+    case 0xCF:
+    case 0xFF: return 300000;               // partial refresh
+    case 0xC0: return 1000;                 // clock + analog on
+    case 0xB1:                              // load temperature and OTP LUT
+    case 0x91: return 5000;                 // load OTP LUT
+    default:   return 100000;
+    }
+}
+
+static unsigned long long ByteNs(void) {
+    return 8000000000ULL / spi_clock;
+}
+
+static void SendByte(unsigned char value) {
+    if (pin_level[DC_PIN] == LOW) {
+        Record(TRACE_CMD);
+        if (trace) {
+            fputc(value, trace);
+        }
+        panel->Command(value);
+        if (value == 0x12 || value == 0x20) {
+            busy_until_ns = now_ns + 1000ULL * BusyTimeUs(value, panel->LastUpdateControl());
+        }
+    } else if (spi_limit != 0 && spi_clock > spi_limit) {
+        /* too fast for the panel: the byte is lost */
+    } else {
+        if (data_run.empty()) {
+            data_run_us = now_ns / 1000;
+        }
+        data_run.push_back(value);
+        panel->Data(value);
+        unsigned char command = panel->LastCommand();
+        if (command == 0x46 || command == 0x47) {
+            busy_until_ns = now_ns + 1000ULL * BusyTimeUs(command, 0);
+        }
+    }
+    now_ns += ByteNs();
+}
+
+void EpdHostPinWrite(unsigned long pin, int value) {
+    if (pin_level[pin] == value) {
+        return;
+    }
+    pin_level[pin] = value;
+    Record(TRACE_GPIO);
+    if (trace) {
+        fputc((int)pin, trace);
+        fputc(value, trace);
+    }
+    if (pin == RST_PIN && value == HIGH) {
+        panel->HardwareReset();
+        busy_until_ns = now_ns + 1000000ULL;
+    }
+}
+
+int EpdHostPinRead(unsigned long pin) {
+    if (pin == BUSY_PIN) {
+        return now_ns < busy_until_ns ? HIGH : LOW;
+    }
+    return pin_level[pin];
+}
+
+/* -------------------------------------------------------------------------
+ * host control API
+ * ---------------------------------------------------------------------- */
+
+int EpdHostOpen(const char* path, int width_px, int height, int flags) {
+    trace = fopen(path, "wb");
+    if (trace == NULL) {
+        return -1;
+    }
+    delete panel;
+    panel = new PanelModel(width_px, height);
+    now_ns = 0;
+    last_record_us = 0;
+    busy_until_ns = 0;
+    for (unsigned int i = 0; i < sizeof(pin_level) / sizeof(pin_level[0]); i++) {
+        pin_level[i] = HIGH;
+    }
+    pin_level[BUSY_PIN] = LOW;
+
+    fwrite(TRACE_MAGIC, 1, 4, trace);
+    fputc(TRACE_VERSION, trace);
+    fputc(width_px & 0xFF, trace);
+    fputc(width_px >> 8, trace);
+    fputc(height & 0xFF, trace);
+    fputc(height >> 8, trace);
+    fputc(flags, trace);
+
+    Record(TRACE_CLOCK);
+    PutVarint(spi_clock);
+    return 0;
+}
+
+void EpdHostClose(void) {
+    FlushData();
+    if (trace) {
+        fclose(trace);
+        trace = NULL;
+    }
+}
+
+void EpdHostMark(const char* label) {
+    size_t len = strlen(label);
+    if (len > 255) {
+        len = 255;
+    }
+    Record(TRACE_MARK);
+    if (trace) {
+        fputc((int)len, trace);
+        fwrite(label, 1, len, trace);
+    }
+}
+
+void EpdHostAdvance(unsigned long us) {
+    now_ns += 1000ULL * us;
+}
+
+void EpdHostSetTemperature(int celsius) {
+    panel->SetTemperature(celsius);
+}
+
+void EpdHostSetSpiLimit(unsigned long hz) {
+    spi_limit = hz;
+}
+
+unsigned long long EpdHostNowUs(void) {
+    return now_ns / 1000;
+}
+
+PanelModel& EpdHostPanel(void) {
+    return *panel;
+}
+
+/* -------------------------------------------------------------------------
+ * Arduino API on the virtual clock
+ * ---------------------------------------------------------------------- */
+
+void pinMode(unsigned long, unsigned long) {
+}
+
+void digitalWrite(unsigned long pin, unsigned long value) {
+    EpdHostPinWrite(pin, value ? HIGH : LOW);
+}
+
+int digitalRead(unsigned long pin) {
+    return EpdHostPinRead(pin);
+}
+
+void delay(unsigned long ms) {
+    Record(TRACE_DELAY);
+    if (trace) {
+        PutVarint(ms);
+    }
+    now_ns += 1000000ULL * ms;
+}
+
+unsigned long millis(void) {
+    return (unsigned long)(now_ns / 1000000);
+}
+
+unsigned long micros(void) {
+    return (unsigned long)(now_ns / 1000);
+}
+
+/* Another task runs for a while */
+void yield(void) {
+    now_ns += 10000;
+}
+
+void HostSerial::print(const char* s) {
+    if (getenv("EPDTRACE_VERBOSE")) {
+        fputs(s, stderr);
+    }
+}
+
+void HostSerial::println(const char* s) {
+    print(s);
+    print("\n");
+}
+
+/* -------------------------------------------------------------------------
+ * EpdIf
+ * ---------------------------------------------------------------------- */
+
+EpdIf::EpdIf() {
+};
+
+EpdIf::~EpdIf() {
+};
+
+void EpdIf::DigitalWrite(int pin, int value) {
+    digitalWrite(pin, value);
+}
+
+int EpdIf::DigitalRead(int pin) {
+    return digitalRead(pin);
+}
+
+void EpdIf::DelayMs(unsigned int delaytime) {
+    delay(delaytime);
+}
+
+void EpdIf::SpiTransfer(unsigned char data) {
+    EpdGpioWrite(panel_cs[active], LOW);
+    SendByte(data);
+    EpdGpioWrite(panel_cs[active], HIGH);
+}
+
+void EpdIf::SpiReadBlock(unsigned char* data, unsigned int len) {
+    EpdGpioWrite(panel_cs[active], LOW);
+    Record(TRACE_READ);
+    if (trace) {
+        PutVarint(len);
+    }
+    for (unsigned int i = 0; i < len; i++) {
+        data[i] = panel->Read();
+        now_ns += ByteNs();
+    }
+    EpdGpioWrite(panel_cs[active], HIGH);
+}
+
+void EpdIf::SetSpiClock(unsigned long hz) {
+    spi_clock = hz;
+    Record(TRACE_CLOCK);
+    if (trace) {
+        PutVarint(hz);
+    }
+}
+
+unsigned long EpdIf::GetSpiClock(void) {
+    return spi_clock;
+}
+
+void EpdIf::SpiWriteBlock(const unsigned char* data, unsigned int len) {
+    EpdGpioWrite(panel_cs[active], LOW);
+    for (unsigned int i = 0; i < len; i++) {
+        SendByte(data[i]);
+    }
+    EpdGpioWrite(panel_cs[active], HIGH);
+}
+
+void EpdIf::SpiWriteRepeat(unsigned char value, unsigned int len) {
+    EpdGpioWrite(panel_cs[active], LOW);
+    Record(TRACE_FILL);
+    if (trace) {
+        fputc(value, trace);
+        PutVarint(len);
+    }
+    for (unsigned int i = 0; i < len; i++) {
+        panel->Data(value);
+    }
+    now_ns += ByteNs() * len;
+    EpdGpioWrite(panel_cs[active], HIGH);
+}
+
+/* Simulated EasyDMA: the bytes reach the panel model at once, the transfer
+ * completes when the virtual clock passes its wire time */
+int EpdIf::SpiWriteBlockAsync(const unsigned char* data, unsigned int len, EpdIfCallback done) {
+    if (async_active) {
+        return -1;
+    }
+    EpdGpioWrite(panel_cs[active], LOW);
+    Record(TRACE_DMA);
+    if (trace) {
+        PutVarint(len);
+    }
+    unsigned long long start_ns = now_ns;
+    for (unsigned int i = 0; i < len; i++) {
+        SendByte(data[i]);
+    }
+    FlushData();
+    async_done_ns = now_ns;
+    now_ns = start_ns;
+    async_done = done;
+    async_active = true;
+    return 0;
+}
+
+bool EpdIf::SpiAsyncPoll(void) {
+    if (!async_active) {
+        return false;
+    }
+    if (now_ns < async_done_ns) {
+        return true;
+    }
+    EpdGpioWrite(panel_cs[active], HIGH);
+    async_active = false;
+    if (async_done != NULL) {
+        async_done();
+    }
+    return async_active;
+}
+
+int EpdIf::WaitBusyIdle(unsigned long timeout_ms) {
+    unsigned long long waited = 0;
+    int ret = EPD_OK;
+    if (now_ns < busy_until_ns) {
+        waited = busy_until_ns - now_ns;
+        if (waited > 1000000ULL * timeout_ms) {
+            waited = 1000000ULL * timeout_ms;
+            ret = EPD_ERR_TIMEOUT;
+        }
+    }
+    Record(TRACE_BUSY);
+    if (trace) {
+        PutVarint(waited / 1000);
+        fputc((unsigned char)(signed char)ret, trace);
+    }
+    now_ns += waited;
+    if (ret != EPD_OK) {
+        EPD_LOG_E(EPD_EV_BUSY_TIMEOUT, busy_mode, waited / 1000000);
+    } else if (waited > 0) {
+        busy_model.Add(busy_mode, (unsigned long)(waited / 1000000));
+        if (busy_mode != EPD_BUSY_OTHER) {
+            EPD_LOG_I(EPD_EV_BUSY_DONE, busy_mode, waited / 1000000);
+        }
+    }
+    busy_mode = EPD_BUSY_OTHER;
+    return ret;
+}
+
+void EpdIf::BusyArm(void) {
+    busy_armed_ns = now_ns;
+    busy_timing = true;
+}
+
+bool EpdIf::BusyDone(void) {
+    if (now_ns < busy_until_ns) {
+        return false;
+    }
+    if (busy_timing) {
+        busy_model.Add(busy_mode, (unsigned long)((busy_until_ns - busy_armed_ns) / 1000000));
+        EPD_LOG_I(EPD_EV_BUSY_DONE, busy_mode, (busy_until_ns - busy_armed_ns) / 1000000);
+        busy_mode = EPD_BUSY_OTHER;
+        busy_timing = false;
+    }
+    return true;
+}
+
+void EpdIf::SetBusyMode(unsigned char mode) {
+    busy_mode = mode;
+}
+
+void EpdIf::GetBusyStats(unsigned char mode, EpdBusyStats* stats) {
+    busy_model.Stats(mode, stats);
+}
+
+int EpdIf::RunSequence(const unsigned char* seq, unsigned long timeout_ms) {
+    EpdGpioWrite(panel_cs[active], LOW);
+    while (seq[0] != EPD_SEQ_END) {
+        unsigned int len = seq[1] & EPD_SEQ_LEN_MASK;
+        DcPin::Low();
+        SendByte(seq[0]);
+        if (len > 0) {
+            DcPin::High();
+            for (unsigned int i = 0; i < len; i++) {
+                SendByte(seq[2 + i]);
+            }
+        }
+        if (seq[1] & EPD_SEQ_WAIT) {
+            EpdGpioWrite(panel_cs[active], HIGH);
+            int ret = WaitBusyIdle(timeout_ms);
+            if (ret != EPD_OK) {
+                return ret;
+            }
+            EpdGpioWrite(panel_cs[active], LOW);
+        }
+        seq += 2 + len;
+    }
+    EpdGpioWrite(panel_cs[active], HIGH);
+    return EPD_OK;
+}
+
+int EpdIf::AddPanel(unsigned long cs, unsigned long) {
+    if (panel_count >= EPD_MAX_PANELS) {
+        return -1;
+    }
+    panel_cs[panel_count] = cs;
+    return panel_count++;
+}
+
+int EpdIf::SelectPanel(int panel) {
+    if (panel < 0 || panel >= panel_count || (async_active && panel != active)) {
+        return -1;
+    }
+    active = panel;
+    return 0;
+}
+
+int EpdIf::ActivePanel(void) {
+    return active;
+}
+
+bool EpdIf::SpiBusy(void) {
+    return async_active;
+}
+
+void EpdIf::WaitBusyEvent(unsigned long timeout_ms) {
+    unsigned long long limit = now_ns + 1000000ULL * timeout_ms;
+    now_ns = busy_until_ns > now_ns && busy_until_ns < limit ? busy_until_ns : limit;
+}
+
+int EpdIf::IfInit(void) {
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ *  @filename   :   epdlogdump.cpp
+ *  @brief      :   Decodes the event log dump lines ("L ...") written by
+ *                  EpdLog::Format back into event names and arguments.
+ *                  Any other line (ordinary serial output) is passed
+ *                  through unchanged, so a raw serial capture can be fed
+ *                  in as is.
+ *
+ *                  usage: epdlogdump [capture.txt]     (default stdin)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "epdlog.h"
+
+/* EpdLog::Write is never called here; this satisfies the link of epdlog.cpp */
+unsigned long millis(void) {
+    return 0;
+}
+
+struct EventInfo {
+    unsigned int id;
+    const char* name;
+    const char* a;
+    const char* b;
+};
+
+#define EPD_LOG_INFO_ROW(name, id, text, a, b)  { id, text, a, b },
+static const EventInfo events[] = {
+    EPD_LOG_EVENTS(EPD_LOG_INFO_ROW)
+};
+#undef EPD_LOG_INFO_ROW
+
+static const EventInfo* Lookup(unsigned int id) {
+    for (size_t i = 0; i < sizeof(events) / sizeof(events[0]); i++) {
+        if (events[i].id == id) {
+            return &events[i];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [capture.txt]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2 && (in = fopen(argv[1], "r")) == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    char line[256];
+    unsigned long lost;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        EpdLogEntry e;
+        if (sscanf(line, "L lost %lu", &lost) == 1) {
+            printf("           -- %lu events lost --\n", lost);
+        } else if (EpdLog::Parse(line, &e)) {
+            const EventInfo* info = Lookup(e.id);
+            if (info != NULL) {
+                printf("%7lu.%03lu %-14s %s=%u %s=%ld\n", (unsigned long)e.time_ms / 1000,
+                       (unsigned long)e.time_ms % 1000, info->name, info->a, e.a, info->b, (long)e.b);
+            } else {
+                printf("%7lu.%03lu event-0x%04x a=%u b=%ld\n", (unsigned long)e.time_ms / 1000,
+                       (unsigned long)e.time_ms % 1000, e.id, e.a, (long)e.b);
+            }
+        } else {
+            fputs(line, stdout);
+        }
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    return 0;
+}
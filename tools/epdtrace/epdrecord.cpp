@@ -0,0 +1,519 @@
+/**
+ *  @filename   :   epdrecord.cpp
+ *  @brief      :   Runs a fixed scenario through one panel driver on the
+ *                  recording EpdIf and writes the trace. The driver is
+ *                  chosen at build time (USE_EPD_2IN13 / _2IN9 / _4IN2).
+ *
+ *                  usage: epdrecord_<panel> out.trace
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "epdarbiter.h"
+#include "epddiff.h"
+#include "epdhost.h"
+#include "epdtrace.h"
+
+/* RAM row holding frame row r: the tri-color drivers write in Y-decrement
+ * mode starting at RAM row EPD_HEIGHT - 1 */
+#if defined(USE_EPD_2IN13)
+#include "epd2in13_V3.h"
+#define TRACE_FLAGS     0
+#define RAM_ROW(r)      (r)
+#elif defined(USE_EPD_2IN9)
+#include "epd2in9b_V3.h"
+#define TRACE_FLAGS     TRACE_FLAG_TRICOLOR
+#define RAM_ROW(r)      (EPD_HEIGHT - 1 - (r))
+#elif defined(USE_EPD_4IN2)
+#include "epd4in2b_V2.h"
+#define TRACE_FLAGS     TRACE_FLAG_TRICOLOR
+#define RAM_ROW(r)      (EPD_HEIGHT - 1 - (r))
+#else
+#error "define USE_EPD_2IN13, USE_EPD_2IN9 or USE_EPD_4IN2"
+#endif
+
+#define FRAME_BYTES     (((EPD_WIDTH + 7) / 8) * EPD_HEIGHT)
+
+/* Main loop period while an async upload or refresh is in flight */
+#define POLL_US         1000
+
+/* Byte pattern without row or column symmetry, so misplaced rows show up;
+ * phase makes two frames differ everywhere */
+static void Pattern(std::vector<unsigned char>& frame, int phase) {
+    for (int i = 0; i < FRAME_BYTES; i++) {
+        frame[i] = (unsigned char)(i * 7 + (i >> 4) * 13 + phase * 101);
+    }
+}
+
+/* Copy of frame with rows [first, last] changed, as a small UI update */
+static std::vector<unsigned char> Touch(const std::vector<unsigned char>& frame, int first, int last) {
+    std::vector<unsigned char> out(frame);
+    int width_bytes = (EPD_WIDTH + 7) / 8;
+    for (int i = first * width_bytes; i < (last + 1) * width_bytes; i++) {
+        out[i] ^= 0x5A;
+    }
+    return out;
+}
+
+#if !defined(USE_EPD_2IN13)
+struct FrameJob {
+    Epd* epd;
+    const unsigned char* black;
+    const unsigned char* red;
+};
+
+static void FrameStart(void* ctx) {
+    FrameJob* job = (FrameJob*)ctx;
+    job->epd->DisplayFrameAsync(job->black, job->red);
+}
+
+static bool FramePoll(void* ctx) {
+    return ((FrameJob*)ctx)->epd->DisplayFrameDone();
+}
+#endif
+
+/* Send one plane through BeginFrame/WriteRows/EndFrame in bands of band rows */
+static void StreamPlane(Epd& epd, unsigned char plane, const std::vector<unsigned char>& frame,
+                        int band, int refresh) {
+    int width_bytes = (EPD_WIDTH + 7) / 8;
+    epd.BeginFrame(plane);
+    for (int y = 0; y < EPD_HEIGHT; y += band) {
+        epd.WriteRows(&frame[y * width_bytes], band < EPD_HEIGHT - y ? band : EPD_HEIGHT - y);
+    }
+    epd.EndFrame(refresh);
+}
+
+static int Check(const char* what, const std::vector<unsigned char>& frame, int plane) {
+    const PanelModel& panel = EpdHostPanel();
+    int width_bytes = panel.WidthBytes();
+    for (int y = 0; y < panel.Height(); y++) {
+        const unsigned char* ram = panel.Plane(plane) + RAM_ROW(y) * width_bytes;
+        if (memcmp(ram, &frame[y * width_bytes], width_bytes) != 0) {
+            fprintf(stderr, "%s: RAM 0x%02X differs in row %d\n", what, plane ? 0x26 : 0x24, y);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s out.trace\n", argv[0]);
+        return 2;
+    }
+    if (EpdHostOpen(argv[1], EPD_WIDTH, EPD_HEIGHT, TRACE_FLAGS) != 0) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    std::vector<unsigned char> black(FRAME_BYTES), other(FRAME_BYTES);
+    Pattern(black, 0);
+    Pattern(other, 1);
+    int rc = 0;
+    Epd epd;
+
+#if defined(USE_EPD_2IN13)
+    EpdHostMark("init-full");
+    epd.Init(FULL);
+    EpdHostMark("clear");
+    epd.Clear();
+    EpdHostMark("display");
+    epd.Display(&black[0]);
+    rc |= Check("display", black, 0);
+
+    /* a fast refresh, then Clear(): the full LUT has to come back */
+    EpdHostMark("fast-display");
+    epd.Display(&other[0], EPD_QUALITY_FAST);
+    EpdHostMark("clear-after-fast");
+    epd.Clear();
+    if (EpdHostPanel().FastLut()) {
+        fprintf(stderr, "clear-after-fast: still on the fast OTP waveform\n");
+        rc |= 1;
+    }
+    epd.Display(&black[0]);
+    EpdHostMark("init-part");
+    epd.Init(PART);
+    EpdHostMark("display-part");
+    epd.DisplayPart(&other[0]);
+    rc |= Check("display-part", other, 0);
+
+    /* one clock tick: Init(PART) again, then the next partial frame */
+    EpdHostMark("tick-init-part");
+    epd.Init(PART);
+    EpdHostMark("tick-display");
+    epd.DisplayPart(&black[0]);
+    rc |= Check("tick-display", black, 0);
+    /* the second partial update in a row: the first one switched the clock
+     * and analog off at its end, this one has to switch them on again */
+    if (EpdHostPanel().UnpoweredUpdates() != 0) {
+        fprintf(stderr, "tick-display: %d updates with the clock or analog off\n",
+                EpdHostPanel().UnpoweredUpdates());
+        rc |= 1;
+    }
+
+    /* seconds tick: only the bottom band changed */
+    std::vector<unsigned char> seconds = Touch(black, 195, EPD_HEIGHT - 1);
+    EpdHostMark("tick-window");
+    epd.DisplayPartWindow(&seconds[0], 0, 195, EPD_WIDTH, EPD_HEIGHT - 195);
+    rc |= Check("tick-window", seconds, 0);
+
+    /* a byte-aligned rectangle in the middle */
+    std::vector<unsigned char> box = Touch(seconds, 40, 79);
+    for (int y = 40; y < 80; y++) {
+        for (int x = 0; x < EPD_ROW_BYTES; x++) {
+            if (x < 2 || x > 5) {
+                box[y * EPD_ROW_BYTES + x] = seconds[y * EPD_ROW_BYTES + x];
+            }
+        }
+    }
+    EpdHostMark("window-box");
+    epd.DisplayPartWindow(&box[0], 16, 40, 45, 40);
+    rc |= Check("window-box", box, 0);
+    EpdHostMark("after-window");
+    epd.DisplayPart(&black[0]);
+    rc |= Check("after-window", black, 0);
+
+    /* shadow diff: a clock tick changing two separate bands */
+    std::vector<unsigned char> shadow(FRAME_BYTES);
+    EpdDiff diff(&shadow[0], EPD_ROW_BYTES, EPD_HEIGHT);
+    diff.Commit(&black[0]);
+    std::vector<unsigned char> tick = Touch(Touch(black, 115, 160), 195, 249);
+    EpdRect bands[3];
+    int n = diff.Bands(&tick[0], bands, 3);
+    EpdHostMark("diff-bands");
+    for (int i = 0; i < n; i++) {
+        epd.WritePartWindow(&tick[0], bands[i].x, bands[i].y, bands[i].w, bands[i].h);
+    }
+    epd.RefreshPart();
+    rc |= Check("diff-bands", tick, 0);
+    diff.Commit(&tick[0]);
+    EpdRect unchanged;
+    if (n != 2 || diff.Compare(&tick[0], &unchanged)) {
+        fprintf(stderr, "diff-bands: %d bands, or unchanged frame reported as changed\n", n);
+        rc |= 1;
+    }
+    printf("diff-bands: %d bands\n", n);
+    EpdHostMark("after-diff");
+    epd.DisplayPart(&black[0]);
+
+    std::vector<unsigned char> touched = Touch(black, 100, 131);
+    epd.SetReadbackDiff(true);
+    EpdHostMark("readback-part");
+    epd.DisplayPart(&touched[0]);
+    rc |= Check("readback-part", touched, 0);
+    epd.SetReadbackDiff(false);
+
+    /* 0x26 written after the full frame, then kept by the controller's
+     * RAM ping-pong through a two-band tick */
+    epd.SetPingPong(true);
+    EpdHostMark("pp-init-full");
+    epd.Init(FULL);
+    EpdHostMark("pp-display");
+    epd.Display(&black[0]);
+    rc |= Check("pp-display", black, 1);
+    EpdHostMark("pp-init-part");
+    epd.Init(PART);
+    EpdHostMark("pp-bands");
+    for (int i = 0; i < n; i++) {
+        epd.WritePartWindow(&tick[0], bands[i].x, bands[i].y, bands[i].w, bands[i].h);
+    }
+    epd.RefreshPart();
+    rc |= Check("pp-bands", tick, 0);
+    rc |= Check("pp-bands", tick, 1);
+    EpdHostMark("pp-display-part");
+    epd.DisplayPart(&black[0]);
+    rc |= Check("pp-display-part", black, 1);
+    epd.SetPingPong(false);
+
+    /* deep sleep mode 1 before a far-off update: RAM kept, wake straight into PART */
+    EpdHostMark("tick-sleep");
+    epd.Sleep();
+    EpdHostMark("wake-init-part");
+    epd.Init(PART);
+    rc |= Check("wake-init-part", black, 0);
+    EpdHostMark("wake-window");
+    epd.DisplayPartWindow(&seconds[0], 0, 195, EPD_WIDTH, EPD_HEIGHT - 195);
+    rc |= Check("wake-window", seconds, 0);
+
+    /* minute-only clock (Anim.cpp SHOW_SECONDS 0): sleep after every update,
+     * wake a minute later; the reset pulse put 0x01/0x11 back to their
+     * power-on values, so the wake has to send them again */
+    std::vector<unsigned char> minute(seconds);
+    for (int m = 0; m < 3; m++) {
+        minute = Touch(minute, 115, 175);
+        EpdHostMark("minute-sleep");
+        epd.Sleep();
+        EpdHostAdvance(60000000UL);
+        EpdHostMark("minute-wake");
+        epd.Init(PART);
+        if (EpdHostPanel().GateLines() != EPD_HEIGHT || EpdHostPanel().EntryMode() != 0x03) {
+            fprintf(stderr, "minute-wake: %d gate lines, entry mode 0x%02X\n",
+                    EpdHostPanel().GateLines(), EpdHostPanel().EntryMode());
+            rc |= 1;
+        }
+        EpdHostMark("minute-window");
+        epd.DisplayPartWindow(&minute[0], 0, 115, EPD_WIDTH, 61);
+        rc |= Check("minute-window", minute, 0);
+        rc |= Check("minute-window", minute, 1);
+    }
+
+    /* a cold panel a temperature period later: next wake picks the cold LUT */
+    EpdHostSetTemperature(-5);
+    EpdHostAdvance(EPD_TEMP_PERIOD_MS * 1000UL);
+    epd.Sleep();
+    EpdHostMark("cold-init-part");
+    epd.Init(PART);
+    printf("temperature: %d C\n", epd.Temperature());
+    if (epd.Temperature() != -5) {
+        fprintf(stderr, "cold-init-part: read %d C\n", epd.Temperature());
+        rc |= 1;
+    }
+
+    /* staying awake in PART mode: the refresh itself re-reads it */
+    EpdHostSetTemperature(25);
+    EpdHostAdvance(EPD_TEMP_PERIOD_MS * 1000UL);
+    EpdHostMark("awake-temp-part");
+    epd.DisplayPart(&seconds[0]);
+    if (epd.Temperature() != 25) {
+        fprintf(stderr, "awake-temp-part: read %d C\n", epd.Temperature());
+        rc |= 1;
+    }
+
+    /* MISO pulled low reads 0x0000: unknown, not 0 degC */
+    EpdHostSetTemperature(0);
+    if (epd.ReadTemperature() != EPD_TEMP_UNKNOWN) {
+        fprintf(stderr, "read-temp-zero: took 0x0000 as %d C\n", epd.Temperature());
+        rc |= 1;
+    }
+    EpdHostSetTemperature(25);
+#else
+    std::vector<unsigned char> red(FRAME_BYTES);
+    Pattern(red, 1);
+
+    EpdHostMark("init");
+    epd.Init();
+    EpdHostMark("clear");
+#if defined(USE_EPD_2IN9)
+    epd.Clear();
+#else
+    epd.ClearFrame();
+#endif
+    rc |= Check("clear", std::vector<unsigned char>(FRAME_BYTES, 0xFF), 0);
+    rc |= Check("clear", std::vector<unsigned char>(FRAME_BYTES, 0x00), 1);
+    EpdHostMark("display");
+    epd.DisplayFrame(&black[0], &red[0]);
+    rc |= Check("display", black, 0);
+    rc |= Check("display", red, 1);
+    EpdHostMark("display-async");
+    epd.DisplayFrameAsync(&other[0], &black[0]);
+    unsigned long polls = 0;
+    while (!epd.DisplayFrameDone()) {
+        EpdHostAdvance(POLL_US);
+        polls++;
+    }
+    rc |= Check("display-async", other, 0);
+    rc |= Check("display-async", black, 1);
+    printf("display-async: %lu polls of %d us\n", polls, POLL_US);
+
+    /* two queued frames through the bus arbiter (the model is one panel) */
+    EpdHostMark("arbiter");
+    EpdArbiter arbiter;
+    FrameJob first = { &epd, &black[0], &red[0] };
+    FrameJob second = { &epd, &red[0], &other[0] };
+    arbiter.Submit(0, FrameStart, FramePoll, &first);
+    arbiter.Submit(0, FrameStart, FramePoll, &second);
+    arbiter.RunUntilIdle();
+    rc |= Check("arbiter", red, 0);
+    rc |= Check("arbiter", other, 1);
+
+    std::vector<unsigned char> touched = Touch(red, 100, 131);
+    epd.SetReadbackDiff(true);
+    EpdHostMark("readback");
+    epd.DisplayFrame(&touched[0], &other[0]);
+    rc |= Check("readback", touched, 0);
+    rc |= Check("readback", other, 1);
+    epd.SetReadbackDiff(false);
+
+    /* B/W-only layout: the blank red plane is filled on chip, then the
+     * same frame again with EPD_HINT_HASH sends neither plane */
+    std::vector<unsigned char> no_red(FRAME_BYTES, 0x00);
+    EpdHostMark("red-empty");
+    epd.DisplayFrame(&other[0], &no_red[0]);
+    rc |= Check("red-empty", other, 0);
+    rc |= Check("red-empty", no_red, 1);
+    EpdHostMark("unchanged");
+    epd.DisplayFrame(&other[0], &no_red[0], EPD_HINT_HASH, EPD_HINT_HASH);
+    std::vector<unsigned char> ticked = Touch(other, 10, 19);
+    EpdHostMark("black-only");
+    epd.DisplayFrame(&ticked[0], &no_red[0]);
+    rc |= Check("black-only", ticked, 0);
+    rc |= Check("black-only", no_red, 1);
+
+    /* red badge: only its bounding box is uploaded, the rest of 0x26 is
+     * filled on chip; then the same badge from a window-sized buffer */
+    std::vector<unsigned char> badge(FRAME_BYTES, 0x00);
+    for (int y = 30; y < 54; y++) {
+        for (int xb = 3; xb < 7; xb++) {
+            badge[y * EPD_ROW_BYTES + xb] = (unsigned char)(y * 5 + xb);
+        }
+    }
+    EpdRect badge_box = { 24, 30, 32, 24 };
+    EpdHostMark("red-box");
+    epd.DisplayFrameRedBox(&ticked[0], &badge[0], badge_box);
+    rc |= Check("red-box", ticked, 0);
+    rc |= Check("red-box", badge, 1);
+    std::vector<unsigned char> badge_window(4 * 24);
+    for (int y = 0; y < 24; y++) {
+        memcpy(&badge_window[y * 4], &badge[(30 + y) * EPD_ROW_BYTES + 3], 4);
+    }
+    EpdHostMark("red-window");
+    epd.DisplayFrameRedWindow(&ticked[0], &badge_window[0], badge_box);
+    rc |= Check("red-window", ticked, 0);
+    rc |= Check("red-window", badge, 1);
+#endif
+
+    /* streamed in bands of an odd height, as a build without a frame buffer */
+#if defined(USE_EPD_2IN13)
+    EpdHostMark("stream-init");
+    epd.Init(FULL);
+    EpdHostMark("stream");
+    StreamPlane(epd, EPD_PLANE_BW, other, 37, EPD_REFRESH_FULL);
+    rc |= Check("stream", other, 0);
+
+    /* an image push with the fast waveform, then a normal full refresh */
+    EpdHostMark("display-fast");
+    epd.Display(&black[0], EPD_QUALITY_FAST);
+    rc |= Check("display-fast", black, 0);
+    EpdHostMark("display-high");
+    epd.Display(&other[0]);
+    rc |= Check("display-high", other, 0);
+
+    /* 4-gray frame: the high bit of each pixel lands in 0x24, the low in 0x26 */
+    std::vector<unsigned char> gray(EPD_GRAY_ROW_BYTES * EPD_HEIGHT);
+    std::vector<unsigned char> hi(FRAME_BYTES), lo(FRAME_BYTES);
+    for (size_t i = 0; i < gray.size(); i++) {
+        gray[i] = (unsigned char)(i * 37 + (i >> 5) * 11);
+    }
+    for (int i = 0; i < FRAME_BYTES; i++) {
+        unsigned int px = (gray[2 * i] << 8) | gray[2 * i + 1];
+        hi[i] = lo[i] = 0;
+        for (int p = 0; p < 8; p++) {
+            hi[i] |= ((px >> (15 - 2 * p)) & 1) << (7 - p);
+            lo[i] |= ((px >> (14 - 2 * p)) & 1) << (7 - p);
+        }
+    }
+    EpdHostMark("display-gray4");
+    epd.DisplayGray4(&gray[0]);
+    rc |= Check("display-gray4", hi, 0);
+    rc |= Check("display-gray4", lo, 1);
+
+    /* back to black and white: mode LUT reloaded, 0x26 rewritten */
+    EpdHostMark("after-gray4");
+    epd.Display(&black[0]);
+    rc |= Check("after-gray4", black, 0);
+    rc |= Check("after-gray4", black, 1);
+#else
+    EpdHostMark("stream");
+    StreamPlane(epd, EPD_PLANE_BW, other, 37, EPD_REFRESH_NONE);
+    StreamPlane(epd, EPD_PLANE_RED, black, 37, EPD_REFRESH_FULL);
+    rc |= Check("stream", other, 0);
+    rc |= Check("stream", black, 1);
+#endif
+#if defined(USE_EPD_2IN9)
+    /* black-only window: columns 16..79 of rows 40..79 change, red stays */
+    std::vector<unsigned char> changed = Touch(other, 40, 79);
+    std::vector<unsigned char> expect(other);
+    for (int y = 40; y < 80; y++) {
+        memcpy(&expect[y * EPD_ROW_BYTES + 2], &changed[y * EPD_ROW_BYTES + 2], 8);
+    }
+    EpdHostMark("black-part");
+    epd.DisplayPartBlack(&changed[0], 16, 40, 64, 40);
+    rc |= Check("black-part", expect, 0);
+    rc |= Check("black-part", black, 1);
+
+    /* a second black-only window reuses the uploaded LUT; the full refresh
+     * after it loads the OTP waveform and voltages back first */
+    EpdHostMark("black-part-2");
+    epd.DisplayPartBlack(&other[0], 16, 40, 64, 40);
+    EpdHostMark("full-after-part");
+    epd.Clear();
+#endif
+#if defined(USE_EPD_4IN2)
+    /* per-plane dirty rectangles: a black box and a red band */
+    std::vector<unsigned char> box_black = Touch(other, 40, 79);
+    std::vector<unsigned char> band_red = Touch(black, 200, 219);
+    std::vector<unsigned char> expect_black(other);
+    for (int y = 40; y < 80; y++) {
+        memcpy(&expect_black[y * EPD_ROW_BYTES + 2], &box_black[y * EPD_ROW_BYTES + 2], 8);
+    }
+    EpdRect black_rect = { 19, 40, 58, 40 };    /* rounds out to x 16..79 */
+    EpdRect red_rect = { 0, 200, EPD_WIDTH, 20 };
+    EpdHostMark("windows");
+    epd.DisplayWindows(&box_black[0], &black_rect, 1, &band_red[0], &red_rect, 1);
+    rc |= Check("windows", expect_black, 0);
+    rc |= Check("windows", band_red, 1);
+
+    /* window-sized image, as the partial-window demo sketch draws it */
+    std::vector<unsigned char> tile(8 * 64, 0x3C);
+    for (int y = 0; y < 64; y++) {
+        memcpy(&expect_black[(120 + y) * EPD_ROW_BYTES + 25], &tile[y * 8], 8);
+    }
+    EpdHostMark("window-black");
+    epd.SetPartialWindowBlack(&tile[0], 200, 120, 64, 64);
+    epd.DisplayFrame();
+    rc |= Check("window-black", expect_black, 0);
+    rc |= Check("window-black", band_red, 1);
+#endif
+
+    /* SPI clock calibration on a panel that drops bytes above 8 MHz; the
+     * second run starts with the first run's pattern already in RAM */
+    EpdHostSetSpiLimit(8000000);
+    for (int run = 0; run < 2; run++) {
+        EpdHostMark("spi-calibrate");
+        unsigned long hz = epd.CalibrateSpiClock();
+        if (hz != 8000000) {
+            fprintf(stderr, "spi-calibrate: run %d picked %lu Hz\n", run, hz);
+            rc |= 1;
+        }
+    }
+    EpdHostSetSpiLimit(0);
+
+    static const char* const mode_names[EPD_BUSY_MODES] = { "other", "full", "part", "tricolor", "fast" };
+    for (int mode = 0; mode < EPD_BUSY_MODES; mode++) {
+        EpdBusyStats stats;
+        EpdIf::GetBusyStats(mode, &stats);
+        if (stats.count > 0) {
+            printf("busy %-8s n=%u min=%lu mean=%lu p95=%lu ms\n", mode_names[mode],
+                   stats.count, stats.min_ms, stats.mean_ms, stats.p95_ms);
+        }
+    }
+
+    if (EpdHostPanel().UnpoweredUpdates() != 0) {
+        fprintf(stderr, "%d updates with the clock or analog off\n", EpdHostPanel().UnpoweredUpdates());
+        rc |= 1;
+    }
+
+    EpdHostMark("sleep");
+    epd.Sleep();
+    if (!EpdHostPanel().Asleep()) {
+        fprintf(stderr, "sleep: controller not in deep sleep\n");
+        rc |= 1;
+    }
+    EpdHostClose();
+
+    /* event log as the firmware dumps it, for epdlogdump */
+    EpdLogEntry entries[EPD_LOG_ENTRIES];
+    unsigned long lost;
+    unsigned int logged = EpdLog::Read(entries, EPD_LOG_ENTRIES, &lost);
+    if (lost > 0) {
+        printf("L lost %lu\n", lost);
+    }
+    for (unsigned int i = 0; i < logged; i++) {
+        char line[EPD_LOG_LINE];
+        EpdLog::Format(&entries[i], line);
+        printf("%s\n", line);
+    }
+    return rc;
+}
@@ -0,0 +1,215 @@
+/**
+ *  @filename   :   epdreplay.cpp
+ *  @brief      :   Replays a trace written by the recording EpdIf: rebuilds
+ *                  the panel RAM through PanelModel, writes it out as PBM
+ *                  images and prints per-phase byte counts and time budgets.
+ *
+ *                  usage: epdreplay in.trace [out-prefix]
+ *                  writes <prefix>_bw.pbm, and <prefix>_red.pbm for
+ *                  tri-color traces
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "epdtrace.h"
+#include "panel_model.h"
+
+struct Phase {
+    std::string name;
+    unsigned long commands;
+    unsigned long data_bytes;
+    unsigned long fill_bytes;
+    unsigned long read_bytes;
+    unsigned long dma_bytes;
+    unsigned long long spi_ns;
+    unsigned long long busy_us;
+    unsigned long long delay_us;
+    unsigned long long start_us;
+    unsigned long long end_us;
+    int errors;
+
+    Phase(const char* name, unsigned long long start)
+        : name(name), commands(0), data_bytes(0), fill_bytes(0), read_bytes(0),
+          dma_bytes(0), spi_ns(0), busy_us(0), delay_us(0),
+          start_us(start), end_us(start), errors(0) {}
+};
+
+static FILE* in;
+
+static int Byte(void) {
+    int c = fgetc(in);
+    if (c == EOF) {
+        fprintf(stderr, "epdreplay: truncated trace\n");
+        exit(1);
+    }
+    return c;
+}
+
+static unsigned long long Varint(void) {
+    unsigned long long value = 0;
+    int shift = 0;
+    int b;
+    do {
+        b = Byte();
+        value |= (unsigned long long)(b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    return value;
+}
+
+static void NewPhase(std::vector<Phase>& phases, const char* name, unsigned long long now) {
+    if (!phases.empty()) {
+        phases.back().end_us = now;
+    }
+    phases.push_back(Phase(name, now));
+}
+
+/* Panel RAM: 1 = white on 0x24, 1 = red on 0x26; PBM: 1 = black/ink */
+static int WritePbm(const char* path, const PanelModel& panel, int width_px, int plane) {
+    FILE* out = fopen(path, "wb");
+    if (out == NULL) {
+        perror(path);
+        return 1;
+    }
+    fprintf(out, "P4\n%d %d\n", width_px, panel.Height());
+    for (int y = 0; y < panel.Height(); y++) {
+        const unsigned char* row = panel.Row(plane, y);
+        for (int x = 0; x < panel.WidthBytes(); x++) {
+            unsigned char value = row[x];
+            fputc(plane == 0 ? (unsigned char)~value : value, out);
+        }
+    }
+    fclose(out);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s in.trace [out-prefix]\n", argv[0]);
+        return 2;
+    }
+    in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    char magic[4];
+    if (fread(magic, 1, 4, in) != 4 || memcmp(magic, TRACE_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not an EPD trace\n", argv[1]);
+        return 2;
+    }
+    if (Byte() != TRACE_VERSION) {
+        fprintf(stderr, "%s: unsupported trace version\n", argv[1]);
+        return 2;
+    }
+    int width_px = Byte();
+    width_px |= Byte() << 8;
+    int height = Byte();
+    height |= Byte() << 8;
+    int flags = Byte();
+
+    PanelModel panel(width_px, height);
+    std::vector<Phase> phases;
+    NewPhase(phases, "(start)", 0);
+
+    unsigned long long now = 0;
+    unsigned long clock = 0;
+    int tag;
+    while ((tag = fgetc(in)) != EOF) {
+        now += Varint();
+        Phase& p = phases.back();
+        unsigned long long byte_ns = clock ? 8000000000ULL / clock : 0;
+        switch (tag) {
+        case TRACE_CMD:
+            panel.Command(Byte());
+            p.commands++;
+            p.spi_ns += byte_ns;
+            break;
+        case TRACE_DATA: {
+            unsigned long long n = Varint();
+            for (unsigned long long i = 0; i < n; i++) {
+                panel.Data(Byte());
+            }
+            p.data_bytes += n;
+            p.spi_ns += byte_ns * n;
+            break;
+        }
+        case TRACE_FILL: {
+            int value = Byte();
+            unsigned long long n = Varint();
+            for (unsigned long long i = 0; i < n; i++) {
+                panel.Data(value);
+            }
+            p.fill_bytes += n;
+            p.spi_ns += byte_ns * n;
+            break;
+        }
+        case TRACE_READ: {
+            unsigned long long n = Varint();
+            for (unsigned long long i = 0; i < n; i++) {
+                panel.Read();
+            }
+            p.read_bytes += n;
+            p.spi_ns += byte_ns * n;
+            break;
+        }
+        case TRACE_GPIO: {
+            Byte();                         // pin
+            Byte();                         // level
+            break;
+        }
+        case TRACE_BUSY:
+            p.busy_us += Varint();
+            if ((signed char)Byte() != 0) {
+                p.errors++;
+            }
+            break;
+        case TRACE_DELAY:
+            p.delay_us += 1000ULL * Varint();
+            break;
+        case TRACE_CLOCK:
+            clock = (unsigned long)Varint();
+            break;
+        case TRACE_MARK: {
+            int len = Byte();
+            std::string name;
+            for (int i = 0; i < len; i++) {
+                name += (char)Byte();
+            }
+            NewPhase(phases, name.c_str(), now);
+            break;
+        }
+        case TRACE_DMA:
+            p.dma_bytes += Varint();        // the bytes follow as TRACE_DATA
+            break;
+        default:
+            fprintf(stderr, "%s: unknown record 0x%02X\n", argv[1], tag);
+            return 1;
+        }
+    }
+    phases.back().end_us = now;
+    fclose(in);
+
+    printf("%-16s %5s %8s %8s %6s %10s %10s %10s %10s\n",
+           "phase", "cmds", "data", "fill", "read", "spi_us", "busy_us", "delay_us", "total_us");
+    for (size_t i = 0; i < phases.size(); i++) {
+        const Phase& p = phases[i];
+        if (i == 0 && p.commands == 0 && p.data_bytes == 0 && p.end_us == 0) {
+            continue;
+        }
+        printf("%-16s %5lu %8lu %8lu %6lu %10llu %10llu %10llu %10llu%s\n",
+               p.name.c_str(), p.commands, p.data_bytes, p.fill_bytes, p.read_bytes,
+               p.spi_ns / 1000, p.busy_us, p.delay_us, p.end_us - p.start_us,
+               p.errors ? "  BUSY TIMEOUT" : "");
+    }
+
+    std::string prefix = argc > 2 ? argv[2] : "epdreplay";
+    int rc = WritePbm((prefix + "_bw.pbm").c_str(), panel, width_px, 0);
+    if (flags & TRACE_FLAG_TRICOLOR) {
+        rc |= WritePbm((prefix + "_red.pbm").c_str(), panel, width_px, 1);
+    }
+    return rc;
+}
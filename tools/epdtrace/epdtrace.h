@@ -0,0 +1,44 @@
+/**
+ *  @filename   :   epdtrace.h
+ *  @brief      :   Binary trace format written by the recording EpdIf
+ *                  (epdif_host.cpp) and read by epdreplay.
+ *
+ *  File layout:
+ *      "EPDT", version (u8), width in pixels (u16 LE), height (u16 LE),
+ *      flags (u8), then records.
+ *
+ *  Every record is a tag byte followed by the time since the previous
+ *  record in microseconds (varint), then a tag-specific payload:
+ *      TRACE_CMD       command byte
+ *      TRACE_DATA      count (varint), count data bytes
+ *      TRACE_FILL      value, count (varint)       - SpiWriteRepeat()
+ *      TRACE_READ      count (varint)              - bytes clocked in
+ *      TRACE_GPIO      pin, level
+ *      TRACE_BUSY      waited us (varint), result (EPD_OK / error, s8)
+ *      TRACE_DELAY     ms (varint)
+ *      TRACE_CLOCK     SPI clock in Hz (varint)
+ *      TRACE_MARK      length (u8), label text   - phase boundary
+ *      TRACE_DMA       count (varint)              - async transfer started
+ *  Varints are unsigned LEB128.
+ */
+
+#ifndef EPDTRACE_H
+#define EPDTRACE_H
+
+#define TRACE_MAGIC         "EPDT"
+#define TRACE_VERSION       1
+
+#define TRACE_FLAG_TRICOLOR 0x01
+
+#define TRACE_CMD           0x01
+#define TRACE_DATA          0x02
+#define TRACE_FILL          0x03
+#define TRACE_READ          0x04
+#define TRACE_GPIO          0x05
+#define TRACE_BUSY          0x06
+#define TRACE_DELAY         0x07
+#define TRACE_CLOCK         0x08
+#define TRACE_MARK          0x09
+#define TRACE_DMA           0x0A
+
+#endif
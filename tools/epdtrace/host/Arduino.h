@@ -0,0 +1,47 @@
+/**
+ *  @filename   :   Arduino.h
+ *  @brief      :   Minimal Arduino API for building the EPD drivers natively
+ *                  on Linux against the recording EpdIf (epdif_host.cpp).
+ *                  Time is virtual and advanced by the recorder.
+ */
+
+#ifndef EPDTRACE_ARDUINO_H
+#define EPDTRACE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define FALLING         2
+#define MSBFIRST        1
+#define SPI_MODE0       0
+
+#define NRF_GPIO_PIN_MAP(port, pin)     (((port) << 5) | ((pin) & 0x1F))
+
+#define PROGMEM
+#define pgm_read_byte(addr)             (*(const unsigned char*)(addr))
+
+void pinMode(unsigned long pin, unsigned long mode);
+void digitalWrite(unsigned long pin, unsigned long value);
+int  digitalRead(unsigned long pin);
+void delay(unsigned long ms);
+unsigned long millis(void);
+unsigned long micros(void);
+void yield(void);
+
+/* Serial output goes to stderr when EPDTRACE_VERBOSE is set */
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    void print(const char* s);
+    void println(const char* s);
+    void println(void) { print("\n"); }
+};
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,26 @@
+/**
+ *  @filename   :   SPI.h
+ *  @brief      :   Placeholder SPI object for the host build. The recording
+ *                  EpdIf never touches it; it only satisfies EpdBus<..., SPI>.
+ */
+
+#ifndef EPDTRACE_SPI_H
+#define EPDTRACE_SPI_H
+
+#include <Arduino.h>
+
+class SPISettings {
+public:
+    SPISettings(unsigned long, int, int) {}
+};
+
+class SPIClass {
+public:
+    void begin(void) {}
+    void end(void) {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction(void) {}
+};
+extern SPIClass SPI;
+
+#endif
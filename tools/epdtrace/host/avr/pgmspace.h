@@ -0,0 +1,2 @@
+/* host build: program memory is ordinary memory */
+#include <Arduino.h>
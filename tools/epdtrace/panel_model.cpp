@@ -0,0 +1,231 @@
+/**
+ *  @filename   :   panel_model.cpp
+ *  @brief      :   SSD1680/SSD1683 RAM interface model, see panel_model.h
+ */
+
+#include <string.h>
+#include "panel_model.h"
+
+PanelModel::PanelModel(int width_px, int height) {
+    this->width_bytes = (width_px + 7) / 8;
+    this->height = height;
+    planes[0].assign(width_bytes * height, 0xFF);
+    planes[1].assign(width_bytes * height, 0x00);
+    command = 0;
+    nargs = 0;
+    update_ctrl = 0;
+    sensor_c = 25;
+    temp_raw = 0;
+    temp_byte = 0;
+    fast_lut = false;
+    unpowered_updates = 0;
+    asleep = false;
+    clock_on = false;
+    analog_on = false;
+    SoftReset();
+}
+
+void PanelModel::HardwareReset(void) {
+    asleep = false;
+    clock_on = false;
+    analog_on = false;
+    SoftReset();
+}
+
+void PanelModel::SoftReset(void) {
+    gate_reverse = false;
+    gate_lines = 0;
+    temp_forced = false;
+    fast_lut = false;
+    entry_mode = 0x03;
+    x_start = 0;
+    x_end = width_bytes - 1;
+    y_start = 0;
+    y_end = height - 1;
+    x = 0;
+    y = 0;
+    read_plane = 0;
+    read_dummy = false;
+    pingpong = false;
+}
+
+void PanelModel::Command(unsigned char command) {
+    this->command = command;
+    nargs = 0;
+    switch (command) {
+    case 0x12:                      // SW reset
+        SoftReset();
+        break;
+    case 0x27:                      // read RAM, first byte is a dummy
+        read_dummy = true;
+        break;
+    case 0x1B:                      // read temperature register
+        temp_byte = 0;
+        break;
+    case 0x20:                      // update; 0x22 bits 7/6 switch the clock
+        if (update_ctrl & 0x80) {   // and analog on, bits 1/0 off at the end
+            clock_on = true;
+        }
+        if (update_ctrl & 0x40) {
+            analog_on = true;
+        }
+        if (((update_ctrl & 0x34) && !clock_on) || ((update_ctrl & 0x04) && !analog_on)) {
+            unpowered_updates++;
+        }
+        if (update_ctrl & 0x20) {   // bit 5 loads the sensor, bit 4 the OTP LUT for 0x1B
+            temp_raw = (sensor_c * 16) & 0xFFF;
+            temp_forced = false;
+        }
+        if (update_ctrl & 0x10) {
+            fast_lut = temp_forced;
+        }
+        if (pingpong && (update_ctrl & 0x0C) == 0x0C) {
+            planes[1] = planes[0];  // display mode 2: the new image becomes the old one
+        }
+        if (update_ctrl & 0x02) {
+            analog_on = false;
+        }
+        if (update_ctrl & 0x01) {
+            clock_on = false;
+        }
+        break;
+    case 0x32:                      // LUT upload
+        fast_lut = false;
+        break;
+    default:
+        break;
+    }
+}
+
+void PanelModel::Data(unsigned char value) {
+    if (command == 0x24 || command == 0x26) {
+        WriteRam(value);
+        return;
+    }
+    if (nargs < (int)sizeof(args)) {
+        args[nargs++] = value;
+    }
+    switch (command) {
+    case 0x01:                      // driver output control
+        if (nargs == 3) {
+            gate_lines = ((args[1] & 0x01) << 8 | args[0]) + 1;
+            gate_reverse = args[2] & 0x01;
+        }
+        break;
+    case 0x11:                      // data entry mode
+        entry_mode = args[0] & 0x07;
+        break;
+    case 0x22:                      // display update control 2
+        update_ctrl = args[0];
+        break;
+    case 0x46:                      // auto write red RAM
+    case 0x47:                      // auto write B/W RAM
+        if (nargs == 1) {
+            FillRam(command == 0x47 ? 0 : 1, (args[0] & 0x80) ? 0xFF : 0x00);
+        }
+        break;
+    case 0x1A:                      // write temperature register
+        if (nargs == 2) {
+            temp_raw = (args[0] << 4) | (args[1] >> 4);
+            temp_forced = true;
+        }
+        break;
+    case 0x37:                      // write register for display option
+        if (nargs == 6) pingpong = args[5] & 0x40;
+        break;
+    case 0x41:                      // read RAM option
+        read_plane = args[0] & 0x01;
+        break;
+    case 0x44:                      // RAM X window
+        if (nargs == 1) x_start = args[0];
+        if (nargs == 2) x_end = args[1];
+        break;
+    case 0x45:                      // RAM Y window
+        if (nargs == 2) y_start = args[0] | (args[1] << 8);
+        if (nargs == 4) y_end = args[2] | (args[3] << 8);
+        break;
+    case 0x4E:                      // RAM X counter
+        x = args[0];
+        break;
+    case 0x4F:                      // RAM Y counter
+        if (nargs == 2) y = args[0] | (args[1] << 8);
+        break;
+    case 0x10:                      // deep sleep, mode 2 does not keep the RAM
+        asleep = (args[0] & 0x03) != 0;
+        if ((args[0] & 0x03) == 0x03) {
+            planes[0].assign(width_bytes * height, 0x00);
+            planes[1].assign(width_bytes * height, 0x00);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+unsigned char PanelModel::Read(void) {
+    if (command == 0x1B) {
+        int byte = temp_byte++;
+        if (byte == 0) return (unsigned char)(temp_raw >> 4);
+        if (byte == 1) return (unsigned char)((temp_raw & 0x0F) << 4);
+        return 0xFF;
+    }
+    if (command != 0x27) {
+        return 0xFF;
+    }
+    if (read_dummy) {
+        read_dummy = false;
+        return 0x00;
+    }
+    unsigned char value = 0xFF;
+    if (x >= 0 && x < width_bytes && y >= 0 && y < height) {
+        value = planes[read_plane][x + y * width_bytes];
+    }
+    Advance();
+    return value;
+}
+
+/* Steps larger than the panel only: one value over the whole RAM window */
+void PanelModel::FillRam(int plane, unsigned char value) {
+    int x0 = x_start < x_end ? x_start : x_end;
+    int x1 = x_start < x_end ? x_end : x_start;
+    int y0 = y_start < y_end ? y_start : y_end;
+    int y1 = y_start < y_end ? y_end : y_start;
+    for (int yy = y0; yy <= y1 && yy < height; yy++) {
+        for (int xx = x0; xx <= x1 && xx < width_bytes; xx++) {
+            planes[plane][xx + yy * width_bytes] = value;
+        }
+    }
+}
+
+void PanelModel::WriteRam(unsigned char value) {
+    int plane = command == 0x24 ? 0 : 1;
+    if (x >= 0 && x < width_bytes && y >= 0 && y < height) {
+        planes[plane][x + y * width_bytes] = value;
+    }
+    Advance();
+}
+
+/* Move the address counter from start towards end of the window in the
+ * direction given by ID[1:0], wrapping and carrying into the other axis;
+ * AM (bit 2) selects which axis moves first. */
+void PanelModel::Advance(void) {
+    int dx = (entry_mode & 0x01) ? 1 : -1;
+    int dy = (entry_mode & 0x02) ? 1 : -1;
+    bool y_first = (entry_mode & 0x04) != 0;
+
+    if (!y_first) {
+        if (x == x_end) {
+            x = x_start;
+            y = (y == y_end) ? y_start : y + dy;
+        } else {
+            x += dx;
+        }
+    } else {
+        if (y == y_end) {
+            y = y_start;
+            x = (x == x_end) ? x_start : x + dx;
+        } else {
+            y += dy;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ *  @filename   :   panel_model.h
+ *  @brief      :   Behavioural model of the SSD1680/SSD1683 RAM interface:
+ *                  data entry mode, RAM window and address counters, the
+ *                  0x24/0x26 planes, auto write RAM (0x46/0x47), RAM
+ *                  readback (0x41/0x27), the temperature register (0x1B)
+ *                  RAM ping-pong (0x37), modelled as 0x24 being copied
+ *                  to 0x26 after each display mode 2 update, and the clock
+ *                  and analog state the 0x22 sequence bits switch.
+ *                  Shared by the recording EpdIf (to answer reads) and by
+ *                  epdreplay (to rebuild the panel image).
+ */
+
+#ifndef PANEL_MODEL_H
+#define PANEL_MODEL_H
+
+#include <vector>
+
+class PanelModel {
+public:
+    PanelModel(int width_px, int height);
+
+    void Command(unsigned char command);
+    void Data(unsigned char value);
+    unsigned char Read(void);
+    void HardwareReset(void);
+
+    int WidthBytes(void) const { return width_bytes; }
+    int Height(void) const { return height; }
+    const unsigned char* Plane(int index) const { return &planes[index][0]; }
+    /* Row in display order: with TB (0x01 bit 0) set, gate 0 shows RAM row
+     * height - 1 */
+    const unsigned char* Row(int index, int row) const {
+        return &planes[index][(gate_reverse ? height - 1 - row : row) * width_bytes];
+    }
+    unsigned char LastUpdateControl(void) const { return update_ctrl; }
+    unsigned char LastCommand(void) const { return command; }
+    /* Sensor reading latched into 0x1B by the next temperature load */
+    void SetTemperature(int celsius) { sensor_c = celsius; }
+    /* Waveform in use is the OTP one for a temperature forced with 0x1A */
+    bool FastLut(void) const { return fast_lut; }
+    /* 0x20 updates that loaded or displayed with the clock or the analog
+     * block off (0x22 bits 7/6 enable them, bits 1/0 switch them off after) */
+    int UnpoweredUpdates(void) const { return unpowered_updates; }
+    /* Gate lines set with 0x01 since the last reset, 0 = power-on value */
+    int GateLines(void) const { return gate_lines; }
+    unsigned char EntryMode(void) const { return entry_mode; }
+    /* In deep sleep (0x10 mode 1 or 2) until the next hardware reset */
+    bool Asleep(void) const { return asleep; }
+
+private:
+    void SoftReset(void);
+    void WriteRam(unsigned char value);
+    void FillRam(int plane, unsigned char value);
+    void Advance(void);
+
+    int width_bytes;
+    int height;
+    std::vector<unsigned char> planes[2];
+
+    unsigned char command;
+    unsigned char args[16];
+    int nargs;
+
+    unsigned char entry_mode;
+    int x_start, x_end, y_start, y_end;
+    int x, y;
+    int read_plane;
+    bool read_dummy;
+    int sensor_c;
+    int temp_raw;           // 12-bit 0x1B value, 1/16 degC
+    int temp_byte;          // next byte of 0x1B to read
+    bool temp_forced;       // 0x1A written since the last sensor load
+    bool fast_lut;
+    bool pingpong;          // 0x37 byte F bit 6
+    bool clock_on;          // oscillator, needed to load and display
+    bool analog_on;         // analog block, needed to display
+    int unpowered_updates;
+    unsigned char update_ctrl;
+    bool gate_reverse;
+    int gate_lines;
+    bool asleep;
+};
+
+#endif